@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/OIJSON_test.dir/src/main.c.o"
+  "CMakeFiles/OIJSON_test.dir/src/main.c.o.d"
+  "CMakeFiles/OIJSON_test.dir/src/oijson.c.o"
+  "CMakeFiles/OIJSON_test.dir/src/oijson.c.o.d"
+  "bin/release/OIJSON_test"
+  "bin/release/OIJSON_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/OIJSON_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/OIJSON_test_cpp.dir/src/main.cpp.o"
+  "CMakeFiles/OIJSON_test_cpp.dir/src/main.cpp.o.d"
+  "CMakeFiles/OIJSON_test_cpp.dir/src/oijson.c.o"
+  "CMakeFiles/OIJSON_test_cpp.dir/src/oijson.c.o.d"
+  "bin/release/OIJSON_test_cpp"
+  "bin/release/OIJSON_test_cpp.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C CXX)
+  include(CMakeFiles/OIJSON_test_cpp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/OIJSON_test_cpp20.dir/src/main.cpp.o"
+  "CMakeFiles/OIJSON_test_cpp20.dir/src/main.cpp.o.d"
+  "CMakeFiles/OIJSON_test_cpp20.dir/src/oijson.c.o"
+  "CMakeFiles/OIJSON_test_cpp20.dir/src/oijson.c.o.d"
+  "bin/release/OIJSON_test_cpp20"
+  "bin/release/OIJSON_test_cpp20.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C CXX)
+  include(CMakeFiles/OIJSON_test_cpp20.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <stdio.h>
 #include "oijson.h"
 
@@ -43,14 +44,15 @@ static void print_json_indented(oijson json, unsigned int indent) {
         case oijson_type_object:
         {
             puts("{");
-            unsigned int count = oijson_object_count(json);
+            oijson_cursor cursor = oijson_cursor_create(json);
+            unsigned int count = oijson_cursor_count(&cursor);
             for (unsigned int i = 0; i < count; i++) {
                 if (i) {
                     puts(",");
                 }
-                print_json_indented(oijson_object_name_by_index(json, i), indent + 1);
+                print_json_indented(oijson_cursor_name_by_index(&cursor, i), indent + 1);
                 putchar(':');
-                oijson value = oijson_object_value_by_index(json, i);
+                oijson value = oijson_cursor_value_by_index(&cursor, i);
                 if (value.type == oijson_type_array || value.type == oijson_type_object) {
                     print_json_indented(value, indent + 1);
                 }
@@ -66,12 +68,13 @@ static void print_json_indented(oijson json, unsigned int indent) {
         case oijson_type_array:
         {
             puts("[");
-            unsigned int count = oijson_array_count(json);
+            oijson_cursor cursor = oijson_cursor_create(json);
+            unsigned int count = oijson_cursor_count(&cursor);
             for (unsigned int i = 0; i < count; i++) {
                 if (i) {
                     puts(",");
                 }
-                print_json_indented(oijson_array_value_by_index(json, i), indent + 1);
+                print_json_indented(oijson_cursor_value_by_index(&cursor, i), indent + 1);
             }
             putchar('\n');
             print_indent(indent);
@@ -215,6 +218,194 @@ static int test_formatted2(const char* string, const char* expected) {
     return test_formatted(string, expected, buffer, 40) && test_formatted(buffer, expected, buffer, 40);
 }
 
+static int test_minify(const char* string, const char* expected) {
+    puts("MINIFY TEST");
+    printf("input: %s -> expected: %s -> got: ", string, expected);
+
+    char buffer[128];
+    if (!oijson_minify(string, string_length(string), buffer, 128)) {
+        puts(oijson_error());
+        return 0;
+    }
+    puts(buffer);
+    if (!string_equal(buffer, expected)) {
+        return 0;
+    }
+
+    char in_place[128];// same result when minifying in place
+    unsigned int size = string_length(string) + 1;
+    for (unsigned int i = 0; i < size; i++) {
+        in_place[i] = string[i];
+    }
+    return oijson_minify(in_place, size, in_place, size) && string_equal(in_place, expected);
+}
+
+static int test_pretty(const char* string, unsigned int indent, const char* expected) {
+    puts("PRETTY TEST");
+    printf("input: %s -> expected:\n%s\n-> got:\n", string, expected);
+    oijson json = oijson_parse(string, string_length(string));
+    char buffer[256];
+    if (!oijson_value_pretty(json, indent, buffer, 256)) {
+        puts(oijson_error());
+        return 0;
+    }
+    puts(buffer);
+    return string_equal(buffer, expected);
+}
+
+static int test_merge_patch(const char* target, const char* patch, const char* expected) {
+    printf("MERGE PATCH TEST: target: %s, patch: %s -> expected: %s -> got: ", target, patch, expected);
+    char buffer[256];
+    if (!oijson_merge_patch(oijson_parse(target, string_length(target)), oijson_parse(patch, string_length(patch)), buffer, sizeof(buffer))) {
+        puts(oijson_error());
+        return 0;
+    }
+    puts(buffer);
+    return string_equal(buffer, expected);
+}
+
+static int test_json_patch(const char* target, const char* patch, const char* expected) {
+    printf("JSON PATCH TEST: target: %s, patch: %s -> expected: %s -> got: ", target, patch, expected);
+    char buffer[128];
+    char scratch[128];
+    if (!oijson_json_patch(oijson_parse(target, string_length(target)), oijson_parse(patch, string_length(patch)), buffer, sizeof(buffer), scratch, sizeof(scratch))) {
+        puts(oijson_error());
+        return expected == 0;
+    }
+    puts(buffer);
+    return expected && string_equal(buffer, expected);
+}
+
+static int test_number_class(const char* value, oijson_number_class expected) {
+    printf("NUMBER CLASS TEST: input: %s -> expected: %d -> got: ", value, expected);
+    oijson_number number;
+    if (!oijson_value_as_number(oijson_parse(value, string_length(value)), &number)) {
+        puts(oijson_error());
+        return 0;
+    }
+    printf("%d\n", number.number_class);
+    return number.number_class == expected;
+}
+
+static int test_project(const char* json, const char* const* paths, unsigned int path_count, const char* expected) {
+    printf("PROJECT TEST: input: %s, first path: %s -> expected: %s -> got: ", json, path_count ? paths[0] : "", expected);
+    char buffer[128];
+    if (!oijson_project(oijson_parse(json, string_length(json)), paths, path_count, buffer, sizeof(buffer))) {
+        puts(oijson_error());
+        return 0;
+    }
+    puts(buffer);
+    return string_equal(buffer, expected);
+}
+
+static oijson_chunk test_chunks[32];
+
+static int test_chunked(const char* json, unsigned int size) {// same result as oijson_parse, whatever the amount of chunks
+    oijson expected = oijson_parse(json, size);
+    for (unsigned int count = 1; count <= sizeof(test_chunks) / sizeof(test_chunks[0]); count++) {
+        oijson result = oijson_parse_chunked(json, size, test_chunks, count);
+        if (result.type != expected.type || result.buffer != expected.buffer || result.size != expected.size) {
+            printf("CHUNKED TEST: %u chunks disagree with oijson_parse for: %.*s\n", count, (int)size, json);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+typedef struct pretty_sink_s {
+    char buffer[512];
+    unsigned int size;
+    unsigned int calls;
+} pretty_sink;
+
+static int pretty_sink_write(void* user_data, const char* data, unsigned int size) {
+    pretty_sink* sink = (pretty_sink*)user_data;
+    sink->calls++;
+    for (unsigned int i = 0; i < size; i++) {
+        if (sink->size + 1 >= sizeof(sink->buffer)) {
+            return 0;
+        }
+        sink->buffer[sink->size++] = data[i];
+    }
+    sink->buffer[sink->size] = '\0';
+    return 1;
+}
+
+static int test_binary(const char* string, int msgpack, const unsigned char* expected, unsigned int expected_size) {
+    printf("%s TEST: input: %s -> got:", msgpack ? "MSGPACK" : "CBOR", string);
+    oijson json = oijson_parse(string, string_length(string));
+    unsigned char buffer[64];
+    unsigned int written = 0;
+    int result = msgpack ? oijson_to_msgpack(json, buffer, sizeof(buffer), &written) : oijson_to_cbor(json, buffer, sizeof(buffer), &written);
+    if (!result) {
+        puts(oijson_error());
+        return 0;
+    }
+    for (unsigned int i = 0; i < written; i++) {
+        printf(" %02x", buffer[i]);
+    }
+    puts("");
+    if (written != expected_size) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < written; i++) {
+        if (buffer[i] != expected[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_cache_lock(void* user_data, unsigned int set) {// counts lookups and inserts, no threads in this test
+    (void)set;
+    (*(unsigned int*)user_data)++;
+}
+
+static void test_cache_unlock(void* user_data, unsigned int set) {
+    (void)user_data;
+    (void)set;
+}
+
+typedef struct test_address_s {
+    char city[8];
+    long zip;
+} test_address;
+
+typedef struct test_person_s {
+    char name[8];
+    int age;
+    double height;
+    int active;
+    test_address address;
+    oijson tags;
+} test_person;
+
+static const oijson_field test_address_fields[] = {// offsets are relative to the nested struct
+    { "city", oijson_field_type_string, offsetof(test_address, city), 8, 0, 0, 0 },
+    { "zip", oijson_field_type_long, offsetof(test_address, zip), 0, 0, 0, 1 },
+};
+
+static const oijson_field test_person_fields[] = {
+    { "name", oijson_field_type_string, offsetof(test_person, name), 8, 0, 0, 0 },
+    { "age", oijson_field_type_int, offsetof(test_person, age), 0, 0, 0, 0 },
+    { "height", oijson_field_type_double, offsetof(test_person, height), 0, 0, 0, 1 },
+    { "active", oijson_field_type_bool, offsetof(test_person, active), 0, 0, 0, 0 },
+    { "address", oijson_field_type_object, offsetof(test_person, address), 0, test_address_fields, 2, 0 },
+    { "tags", oijson_field_type_value, offsetof(test_person, tags), 0, 0, 0, 1 },
+};
+
+static int test_bind(const char* string, int expected_result) {
+    printf("BIND TEST: input: %s -> ", string);
+    test_person person;
+    person.height = -1.0;
+    int result = oijson_bind(oijson_parse(string, string_length(string)), test_person_fields, sizeof(test_person_fields) / sizeof(test_person_fields[0]), &person);
+    puts(result ? "bound" : oijson_error());
+    if (result && !expected_result) {
+        return 0;
+    }
+    return result == expected_result;
+}
+
 static int tests_passed = 0;
 static int tests_count = 0;
 static int tests_passed_partial = 0;
@@ -328,6 +519,20 @@ int main(int argc, char* argv[]) {
     CHECK_TEST(test_long("-19.5e-1", "-1"), 1);
     CHECK_TEST(test_long("19.51e-1", "2"), 1);
     CHECK_TEST(test_long("-19.51e-1", "-2"), 1);
+    CHECK_TEST(test_long("0e99999999999999999999", "0"), 1);
+    CHECK_TEST(test_long("5e-99999999999999999999", "0"), 1);
+    CHECK_TEST(test_long("9e30", "0"), 0);
+    CHECK_TEST(string_equal(oijson_error(), "number out of range"), 1);
+    CHECK_TEST(test_long("9223372036854775808", "0"), 0);
+    CHECK_TEST(test_long("-9223372036854775808.6", "0"), 0);
+    CHECK_TEST(test_long("1e99999999999999999999", "0"), 0);
+    CHECK_TEST(string_equal(oijson_error(), "number out of range"), 1);
+    {
+        int i = 0;
+        CHECK_TEST(oijson_value_as_int(oijson_parse("-2147483648", 11), &i) && i == -2147483647 - 1, 1);
+        CHECK_TEST(oijson_value_as_int(oijson_parse("2147483648", 10), &i), 0);
+        CHECK_TEST(string_equal(oijson_error(), "number out of range"), 1);
+    }
 
     report_partial_tests("long conversion");
 
@@ -389,6 +594,50 @@ int main(int argc, char* argv[]) {
         report_partial_tests("formatted values");
     }
 
+    {
+        CHECK_TEST(test_minify("{}", "{}"), 1);
+        CHECK_TEST(test_minify(" { \"a\" : [ 1 , 2 ] } ", "{\"a\":[1,2]}"), 1);
+        CHECK_TEST(test_minify("[\n\ttrue,\r\n\tfalse,\n\tnull\n]", "[true,false,null]"), 1);
+        CHECK_TEST(test_minify("{ \"spaced name\" : \"  value with  spaces  \" }", "{\"spaced name\":\"  value with  spaces  \"}"), 1);
+        CHECK_TEST(test_minify("[ \"escaped \\\" quote  \" , \"\\\\\" , 0 ]", "[\"escaped \\\" quote  \",\"\\\\\",0]"), 1);
+        CHECK_TEST(test_minify(" \"\\uD834\\uDD1E\" ", "\"\\uD834\\uDD1E\""), 1);// escapes are kept as is
+        CHECK_TEST(test_minify("{\"abcdefghijklmnop\":\"qrstuvwxyz0123456789\",\"long_array\":[10000000,20000000,30000000]}", "{\"abcdefghijklmnop\":\"qrstuvwxyz0123456789\",\"long_array\":[10000000,20000000,30000000]}"), 1);
+
+        char small[8];
+        CHECK_TEST(oijson_minify(" [ 1, 2, 3, 4 ] ", 16, small, 8), 0);// fails - no space for null terminator
+        CHECK_TEST(oijson_minify(" [ 1, 2, 3 ] ", 13, small, 8), 1);
+        CHECK_TEST(string_equal(small, "[1,2,3]"), 1);
+
+        report_partial_tests("minify");
+    }
+
+    {
+        CHECK_TEST(test_pretty("0", 4, "0"), 1);
+        CHECK_TEST(test_pretty(" \"a , b\" ", 4, "\"a , b\""), 1);
+        CHECK_TEST(test_pretty("{ }", 4, "{}"), 1);
+        CHECK_TEST(test_pretty("[ [ ] , { } ]", 2, "[\n  [],\n  {}\n]"), 1);
+        CHECK_TEST(test_pretty("{\"a\":1,\"b\":[true,null]}", 4, "{\n    \"a\": 1,\n    \"b\": [\n        true,\n        null\n    ]\n}"), 1);
+        CHECK_TEST(test_pretty("{\"a\\\"{\":\"[,]\"}", 1, "{\n \"a\\\"{\": \"[,]\"\n}"), 1);// structural characters inside strings
+        CHECK_TEST(test_pretty("[1,2]", 0, "[\n1,\n2\n]"), 1);
+
+        char small[8];
+        oijson json = oijson_parse("[1,2]", 5);
+        CHECK_TEST(oijson_value_pretty(json, 4, small, 8), 0);// fails - does not fit
+
+        const char str[] = "{\"array\":[0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30]}";
+        json = oijson_parse(str, sizeof(str));
+        char expected[512];
+        CHECK_TEST(oijson_value_pretty(json, 2, expected, 512), 1);
+        pretty_sink sink;
+        sink.size = 0;
+        sink.calls = 0;
+        CHECK_TEST(oijson_value_pretty_write(json, 2, pretty_sink_write, &sink), 1);
+        CHECK_TEST(string_equal(sink.buffer, expected), 1);
+        CHECK_TEST(sink.calls <= sink.size / 256 + 1, 1);// writes are batched
+
+        report_partial_tests("pretty");
+    }
+
     {// ARRAY ITERATOR
         const char array_str[] = "[\"abc\",0,{\"a\":null},[0,1],true,false,null]";
         oijson_type array_types[] = {
@@ -451,6 +700,859 @@ int main(int argc, char* argv[]) {
         report_partial_tests("object iterator");
     }
 
+    {// ITERATOR WITH WHITESPACE
+        const char array_str[] = " [ 1 , { \"a\" : [ 2 , 3 ] } , \"x\" ] ";
+        const char* array_values[] = {
+            "1",
+            "{ \"a\" : [ 2 , 3 ] }",
+            "\"x\"",
+        };
+        oijson array = oijson_parse(array_str, sizeof(array_str));
+        oijson_iterator iterator = oijson_iterator_create(array);
+        for (unsigned int i = 0; i < sizeof(array_values) / sizeof(array_values[0]); i++) {
+            CHECK_TEST(iterator.type == oijson_iterator_type_array, 1);
+            CHECK_TEST(iterator.value.size == string_length(array_values[i]), 1);
+            CHECK_TEST(test_json_type(array_values[i], iterator.value.type), 1);
+            oijson_iterator_advance(&iterator);
+        }
+        CHECK_TEST(iterator.type == oijson_iterator_type_invalid, 1);
+        oijson_iterator_advance(&iterator);
+        CHECK_TEST(iterator.type == oijson_iterator_type_invalid, 1);
+
+        const char object_str[] = " { \"a\" : [ ] ,\n\t\"b\\\"\" :\"c\" } ";
+        oijson object = oijson_parse(object_str, sizeof(object_str));
+        iterator = oijson_iterator_create(object);
+        CHECK_TEST(iterator.name.type == oijson_type_string && iterator.name.size == 3, 1);
+        CHECK_TEST(iterator.value.type == oijson_type_array && iterator.value.size == 3, 1);
+        oijson_iterator_advance(&iterator);
+        CHECK_TEST(iterator.name.type == oijson_type_string && iterator.name.size == 5, 1);
+        CHECK_TEST(iterator.value.type == oijson_type_string && iterator.value.size == 3, 1);
+        oijson_iterator_advance(&iterator);
+        CHECK_TEST(iterator.type == oijson_iterator_type_invalid, 1);
+
+        CHECK_TEST(oijson_iterator_create(oijson_parse("{ }", 3)).type == oijson_iterator_type_invalid, 1);
+        CHECK_TEST(oijson_iterator_create(oijson_parse("[ ]", 3)).type == oijson_iterator_type_invalid, 1);
+        report_partial_tests("iterator with whitespace");
+    }
+
+    {// LAZY
+        const char lazy_str[] = "{ \"skip\" : [1, {\"x\" : \"]}\\\"\"}, [[]]], \"id\" : 42, \"bad\" : [1,,2] } ";
+        oijson root = oijson_parse_lazy(lazy_str, sizeof(lazy_str));
+        CHECK_TEST(root.type == oijson_type_object, 1);
+        CHECK_TEST(oijson_parse(lazy_str, sizeof(lazy_str)).type == oijson_type_invalid, 1);
+        int id = 0;
+        CHECK_TEST(oijson_value_as_int(oijson_object_value_by_name(root, "id"), &id) && id == 42, 1);
+        oijson skipped = oijson_object_value_by_name(root, "skip");
+        CHECK_TEST(skipped.type == oijson_type_array && skipped.size == 25, 1);
+        CHECK_TEST(oijson_array_count(skipped) == 3, 1);
+        CHECK_TEST(oijson_validate(skipped), 1);
+        CHECK_TEST(oijson_validate(root), 0);
+        CHECK_TEST(oijson_validate(oijson_parse_lazy("[1, 2] x", 8)), 0);
+        CHECK_TEST(oijson_validate(oijson_parse_lazy(" [1, 2] ", 8)), 1);
+
+        char pretty[64];
+        CHECK_TEST(oijson_value_pretty(oijson_parse_lazy("[1] garbage", 11), 0, pretty, sizeof(pretty)) && string_equal(pretty, "[\n1\n]"), 1);
+
+        CHECK_TEST(oijson_object_value_by_name(oijson_parse_lazy("{\"a\" : [1, 2", 12), "b").type, oijson_type_invalid);// unbalanced
+        CHECK_TEST(oijson_object_value_by_name(oijson_parse_lazy("{\"a\" : tru, \"b\" : 1}", 20), "b").type, oijson_type_invalid);
+        CHECK_TEST(oijson_parse_lazy("\"a\\\"b\"  ", 8).size == 6, 1);
+        CHECK_TEST(oijson_parse_lazy("-12.5e3 ", 8).size == 7, 1);
+        CHECK_TEST(oijson_parse_lazy("\"a\\\"b\" tail", 11).type, oijson_type_invalid);// only whitespace may follow a scalar root
+        CHECK_TEST(oijson_validate(oijson_parse_lazy("1 x", 3)), 0);
+        CHECK_TEST(string_equal(oijson_error(), "invalid value"), 1);
+        CHECK_TEST(oijson_parse_lazy("1 x", 3).type == oijson_type_invalid && string_equal(oijson_error(), "unexpected character after value"), 1);
+        CHECK_TEST(oijson_validate(oijson_parse_lazy("null,", 5)), 0);
+        CHECK_TEST(oijson_validate(oijson_parse_lazy("12456[78", 8)), 0);
+        CHECK_TEST(oijson_validate(oijson_parse_lazy("12456 \0[78", 9)), 1);
+
+        double d = 0.0;
+        long l = 0;
+        CHECK_TEST(oijson_value_as_double(oijson_parse_lazy("1.5.5", 5), &d), 0);// scanned as one number, converted as 1.5
+        CHECK_TEST(string_equal(oijson_error(), "invalid number"), 1);
+        CHECK_TEST(oijson_value_as_long(oijson_parse_lazy("12-3", 4), &l), 0);
+        CHECK_TEST(oijson_value_as_double(oijson_parse_lazy("-12.5e3 ", 8), &d) && d == -12500.0, 1);
+        oijson unseparated = oijson_parse_lazy("[1,2 3]", 7);
+        CHECK_TEST(oijson_array_count(unseparated) == 0, 1);
+        CHECK_TEST(string_equal(oijson_error(), "',' or ']' expected"), 1);
+        CHECK_TEST(oijson_array_value_by_index(unseparated, 2).type == oijson_type_invalid && string_equal(oijson_error(), "',' or ']' expected"), 1);
+        CHECK_TEST(oijson_array_value_by_index(unseparated, 1).type == oijson_type_number, 1);
+        CHECK_TEST(oijson_object_count(oijson_parse_lazy("{\"a\" : 1 \"b\" : 2}", 18)) == 0, 1);
+        CHECK_TEST(string_equal(oijson_error(), "',' or '}' expected"), 1);
+        CHECK_TEST(oijson_array_count(oijson_parse_lazy("[1, 2,]", 7)) == 0, 1);// trailing separator
+        CHECK_TEST(oijson_array_count(oijson_parse_lazy("[ ] tail", 8)) == 0, 1);
+        report_partial_tests("lazy");
+    }
+
+    {// DEPTH
+        static char deep_str[4001];
+        for (unsigned int i = 0; i < 2000; i++) {
+            deep_str[i] = '[';
+            deep_str[4000 - 1 - i] = ']';
+        }
+        unsigned char stack[256];
+        CHECK_TEST(oijson_parse(deep_str, sizeof(deep_str)).type == oijson_type_invalid, 1);// beyond OIJSON_MAX_DEPTH
+        CHECK_TEST(string_equal(oijson_error(), "maximum depth exceeded"), 1);
+        CHECK_TEST(oijson_parse_with_stack(deep_str, sizeof(deep_str), stack, sizeof(stack)).type == oijson_type_array, 1);
+
+        const char nested_str[] = "{\"a\":[{\"b\":[]},{}],\"c\":{\"d\":[[1],{\"e\":null}]}}";
+        CHECK_TEST(oijson_parse_with_stack(nested_str, sizeof(nested_str), stack, 1).type == oijson_type_object, 1);
+        CHECK_TEST(oijson_parse_with_stack("[[[[[[[[1]]]]]]]]", 17, stack, 1).type == oijson_type_array, 1);// 8 levels
+        CHECK_TEST(oijson_parse_with_stack("[[[[[[[[[1]]]]]]]]]", 19, stack, 1).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse_with_stack("1", 1, 0, 0).type == oijson_type_number, 1);
+        CHECK_TEST(oijson_parse_with_stack("[]", 2, 0, 0).type == oijson_type_invalid, 1);
+
+        CHECK_TEST(oijson_parse("[{\"a\":1]}", 10).type == oijson_type_invalid, 1);// mismatched brackets
+        CHECK_TEST(oijson_parse("{\"a\":[1}]", 10).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse("{\"a\" 1}", 7).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse("{,}", 3).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse("[1,]", 4).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse("[[1],[2]", 8).type == oijson_type_invalid, 1);
+        report_partial_tests("depth");
+    }
+
+    {// BLOCK VALIDATION
+        const char* specials[] = { "\\n", "\xc3\xa9", "\\u00e9", "\x01", "\x1f", "\xff", "\\x", "\"" };// valid first
+        int valid_counts[8] = { 0 };
+        for (int s = 0; s < 8; s++) {// each special sequence at every offset of an 8 byte block
+            for (int offset = 0; offset < 17; offset++) {
+                char string[40];
+                int size = 0;
+                string[size++] = '\"';
+                for (int i = 0; i < offset; i++) {
+                    string[size++] = 'a';
+                }
+                for (const char* c = specials[s]; *c; c++) {
+                    string[size++] = *c;
+                }
+                while (size < 39) {
+                    string[size++] = 'z';
+                }
+                string[size++] = '\"';
+                valid_counts[s] += oijson_parse(string, (unsigned int)size).type == oijson_type_string;
+            }
+        }
+        CHECK_TEST(valid_counts[0] == 17 && valid_counts[1] == 17 && valid_counts[2] == 17, 1);
+        CHECK_TEST(valid_counts[3] + valid_counts[4] + valid_counts[5] + valid_counts[6] + valid_counts[7], 0);
+        CHECK_TEST(oijson_parse("\"\x1f\"", 3).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse("\"unterminated string\\\"", 22).type == oijson_type_invalid, 1);
+
+        const char indented[] = "{\n                \"a\" :\t\r\n        [\n                        1\n        ]\n}\n                ";
+        CHECK_TEST(oijson_parse(indented, sizeof(indented) - 1).type == oijson_type_object, 1);
+        CHECK_TEST(oijson_parse("[                 x]", 20).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_parse("[          !      1]", 20).type == oijson_type_invalid, 1);
+
+        int boundary_counts[4] = { 0 };
+        for (int offset = 56; offset < 72; offset++) {// escapes and control characters across the 64 byte stage 1 blocks
+            char string[96];
+            int size = 0;
+            string[size++] = '[';
+            string[size++] = '\"';
+            for (int i = 0; i < offset; i++) {
+                string[size++] = 'a';
+            }
+            string[size++] = '\\';
+            string[size++] = '\\';
+            string[size++] = '\"';
+            string[size++] = ']';
+            boundary_counts[0] += oijson_parse(string, (unsigned int)size).type == oijson_type_array;// even run, closing quote
+            string[size - 4] = 'a';
+            boundary_counts[1] += oijson_parse(string, (unsigned int)size).type == oijson_type_array;// odd run, escaped quote
+            for (int i = 1; i < size - 1; i++) {
+                string[i] = ' ';
+            }
+            string[offset] = '\t';
+            boundary_counts[2] += oijson_parse(string, (unsigned int)size).type == oijson_type_array;
+            string[offset] = '\x01';
+            boundary_counts[3] += oijson_parse(string, (unsigned int)size).type == oijson_type_array;
+        }
+        CHECK_TEST(boundary_counts[0] == 16 && boundary_counts[2] == 16, 1);
+        CHECK_TEST(boundary_counts[1] + boundary_counts[3], 0);
+        report_partial_tests("block validation");
+    }
+
+    {// INDEX
+        char index_str[] = " { \"name\" : \"config\", \"values\" : [1, 2, 3] } ";
+        oijson root = oijson_parse(index_str, sizeof(index_str));
+        unsigned char index[OIJSON_INDEX_SIZE];
+        CHECK_TEST(oijson_index_save(index_str, sizeof(index_str), root, index, sizeof(index)), 1);
+        CHECK_TEST(oijson_index_save(index_str, sizeof(index_str), root, index, sizeof(index) - 1), 0);
+        CHECK_TEST(oijson_index_save(index_str, 4, root, index, sizeof(index)), 0);// value outside json
+
+        oijson loaded = oijson_index_load(index, sizeof(index), index_str, sizeof(index_str), 1);
+        CHECK_TEST(loaded.type == root.type && loaded.buffer == root.buffer && loaded.size == root.size, 1);
+        CHECK_TEST(oijson_array_count(oijson_object_value_by_name(loaded, "values")) == 3, 1);
+        CHECK_TEST(oijson_index_load(index, sizeof(index), index_str, sizeof(index_str) - 1, 0).type == oijson_type_invalid, 1);// size differs
+
+        index_str[13] = 'C';
+        CHECK_TEST(oijson_index_load(index, sizeof(index), index_str, sizeof(index_str), 1).type == oijson_type_invalid, 1);
+        CHECK_TEST(string_equal(oijson_error(), "checksum mismatch"), 1);
+        CHECK_TEST(oijson_index_load(index, sizeof(index), index_str, sizeof(index_str), 0).type == oijson_type_object, 1);// not verified
+
+        index[4] = 2;
+        CHECK_TEST(oijson_index_load(index, sizeof(index), index_str, sizeof(index_str), 0).type == oijson_type_invalid, 1);
+        index[4] = 1;
+        index[0] = 'X';
+        CHECK_TEST(oijson_index_load(index, sizeof(index), index_str, sizeof(index_str), 0).type == oijson_type_invalid, 1);
+
+        const char dom_index_str[] = " {\"name\" : \"config\", \"values\" : [1, 2.5, {}], \"on\" : true} ";
+        oijson_node saved_nodes[16];
+        oijson_dom saved = oijson_dom_create(saved_nodes, 16);
+        unsigned char dom_index[OIJSON_INDEX_SIZE + 4 + 16 * OIJSON_INDEX_NODE_SIZE];
+        unsigned int dom_index_size = 0;
+        CHECK_TEST(oijson_dom_build(&saved, dom_index_str, sizeof(dom_index_str)) && oijson_index_save_dom(&saved, dom_index, sizeof(dom_index), &dom_index_size), 1);
+        CHECK_TEST(dom_index_size == OIJSON_INDEX_SIZE + 4 + 10 * OIJSON_INDEX_NODE_SIZE && !oijson_index_save_dom(&saved, dom_index, dom_index_size - 1, 0), 1);
+        CHECK_TEST(oijson_index_load(dom_index, dom_index_size, dom_index_str, sizeof(dom_index_str), 1).type == oijson_type_object, 1);// the root is indexed as before
+
+        oijson_node loaded_nodes[16];
+        oijson_dom reopened = oijson_dom_create(loaded_nodes, 16);
+        CHECK_TEST(oijson_index_load_dom(dom_index, dom_index_size, dom_index_str, sizeof(dom_index_str), 1, &reopened) && reopened.count == 10, 1);
+        const oijson_node* values = oijson_dom_value_by_name(&reopened, oijson_dom_root(&reopened), "values");// found without reading the JSON string
+        CHECK_TEST(oijson_dom_count(values) == 3 && oijson_dom_element(&reopened, values, 1)->data.real == 2.5 && oijson_dom_count(oijson_dom_element(&reopened, values, 2)) == 0, 1);
+        CHECK_TEST(oijson_dom_value(&reopened, values).size == 12 && oijson_dom_member(&reopened, oijson_dom_root(&reopened), 2)->type == oijson_type_true, 1);
+        CHECK_TEST(oijson_index_load_dom(index, sizeof(index), index_str, sizeof(index_str), 0, &reopened), 0);// no nodes saved
+        CHECK_TEST(string_equal(oijson_error(), "invalid index") && oijson_dom_root(&reopened) == 0, 1);
+        oijson_dom tiny = oijson_dom_create(loaded_nodes, 9);
+        CHECK_TEST(oijson_index_load_dom(dom_index, dom_index_size, dom_index_str, sizeof(dom_index_str), 0, &tiny), 0);
+        dom_index[OIJSON_INDEX_SIZE + 4 + 8] = 0;// the root's children would include itself
+        CHECK_TEST(oijson_index_load_dom(dom_index, dom_index_size, dom_index_str, sizeof(dom_index_str), 0, &reopened), 0);
+        CHECK_TEST(string_equal(oijson_error(), "index does not match json"), 1);
+        report_partial_tests("index");
+    }
+
+    {// BINARY
+        const char* object_str = "{\"a\":1,\"b\":[true,null,-2,1.5],\"c\":\"x\\ny\"}";
+        const unsigned char object_cbor[] = { 0xa3, 0x61, 0x61, 0x01, 0x61, 0x62, 0x84, 0xf5, 0xf6, 0x21, 0xfa, 0x3f, 0xc0, 0x00, 0x00, 0x61, 0x63, 0x63, 0x78, 0x0a, 0x79 };
+        const unsigned char object_msgpack[] = { 0x83, 0xa1, 0x61, 0x01, 0xa1, 0x62, 0x94, 0xc3, 0xc0, 0xfe, 0xca, 0x3f, 0xc0, 0x00, 0x00, 0xa1, 0x63, 0xa3, 0x78, 0x0a, 0x79 };
+        CHECK_TEST(test_binary(object_str, 0, object_cbor, sizeof(object_cbor)), 1);
+        CHECK_TEST(test_binary(object_str, 1, object_msgpack, sizeof(object_msgpack)), 1);
+
+        const char* numbers_str = "[1000000, -129, 0.1, 1e2, false]";
+        const unsigned char numbers_cbor[] = { 0x85, 0x1a, 0x00, 0x0f, 0x42, 0x40, 0x38, 0x80, 0xfb, 0x3f, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a, 0xfa, 0x42, 0xc8, 0x00, 0x00, 0xf4 };
+        const unsigned char numbers_msgpack[] = { 0x95, 0xce, 0x00, 0x0f, 0x42, 0x40, 0xd1, 0xff, 0x7f, 0xcb, 0x3f, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a, 0xca, 0x42, 0xc8, 0x00, 0x00, 0xc2 };
+        CHECK_TEST(test_binary(numbers_str, 0, numbers_cbor, sizeof(numbers_cbor)), 1);
+        CHECK_TEST(test_binary(numbers_str, 1, numbers_msgpack, sizeof(numbers_msgpack)), 1);
+
+        const char* unicode_str = "\"\\u00e9\\ud83d\\ude00\"";// decoded is shorter than the raw string
+        const unsigned char unicode_cbor[] = { 0x66, 0xc3, 0xa9, 0xf0, 0x9f, 0x98, 0x80 };
+        const unsigned char unicode_msgpack[] = { 0xa6, 0xc3, 0xa9, 0xf0, 0x9f, 0x98, 0x80 };
+        CHECK_TEST(test_binary(unicode_str, 0, unicode_cbor, sizeof(unicode_cbor)), 1);
+        CHECK_TEST(test_binary(unicode_str, 1, unicode_msgpack, sizeof(unicode_msgpack)), 1);
+
+        const char* long_str = "\"abcdefghijklmnopqrstuvwxyz0123456789\"";
+        unsigned char buffer[64];
+        unsigned int written = 0;
+        oijson long_json = oijson_parse(long_str, string_length(long_str));
+        CHECK_TEST(oijson_to_cbor(long_json, buffer, sizeof(buffer), &written) && written == 38 && buffer[0] == 0x78 && buffer[1] == 36, 1);
+        CHECK_TEST(oijson_to_msgpack(long_json, buffer, sizeof(buffer), &written) && written == 38 && buffer[0] == 0xd9 && buffer[1] == 36, 1);
+        CHECK_TEST(oijson_to_msgpack(long_json, buffer, 37, &written), 0);
+        CHECK_TEST(oijson_to_cbor(oijson_parse(object_str, string_length(object_str)), buffer, 8, 0), 0);
+
+        const char* wide_str = "[[0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0],1]";// 24 elements need a longer header in both formats
+        oijson wide_json = oijson_parse(wide_str, string_length(wide_str));
+        CHECK_TEST(oijson_to_cbor(wide_json, buffer, sizeof(buffer), &written) && written == 28 && buffer[0] == 0x82 && buffer[1] == 0x98 && buffer[2] == 24 && buffer[3] == 0 && buffer[27] == 0x01, 1);
+        CHECK_TEST(oijson_to_msgpack(wide_json, buffer, sizeof(buffer), &written) && written == 29 && buffer[0] == 0x92 && buffer[1] == (unsigned char)0xdc && buffer[3] == 24 && buffer[4] == 0 && buffer[28] == 0x01, 1);
+        CHECK_TEST(oijson_to_msgpack(wide_json, buffer, 28, &written), 0);
+
+        const char* limits_str = "[9223372036854775807,18446744073709551615,-9223372036854775808,18446744073709551616,1e39]";// past 64 bits or float range stays a double
+        const unsigned char limits_cbor[] = { 0x85, 0x1b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfa, 0x5f, 0x80, 0x00, 0x00, 0xfb, 0x48, 0x07, 0x82, 0x87, 0xf4, 0x9c, 0x4a, 0x1d };
+        const unsigned char limits_msgpack[] = { 0x95, 0xcf, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xd3, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xca, 0x5f, 0x80, 0x00, 0x00, 0xcb, 0x48, 0x07, 0x82, 0x87, 0xf4, 0x9c, 0x4a, 0x1d };
+        CHECK_TEST(test_binary(limits_str, 0, limits_cbor, sizeof(limits_cbor)), 1);
+        CHECK_TEST(test_binary(limits_str, 1, limits_msgpack, sizeof(limits_msgpack)), 1);
+
+        char deep_str[OIJSON_MAX_DEPTH * 2];
+        unsigned char deep_buffer[OIJSON_MAX_DEPTH];
+        for (unsigned int i = 0; i < OIJSON_MAX_DEPTH; ++i) { deep_str[i] = '['; deep_str[OIJSON_MAX_DEPTH * 2 - 1 - i] = ']'; }
+        oijson deep_json = oijson_parse(deep_str, sizeof(deep_str));
+        CHECK_TEST(oijson_to_cbor(deep_json, deep_buffer, sizeof(deep_buffer), &written) && written == OIJSON_MAX_DEPTH && deep_buffer[0] == 0x81 && deep_buffer[OIJSON_MAX_DEPTH - 1] == 0x80, 1);
+        report_partial_tests("binary");
+    }
+
+    {// CACHE
+        oijson_cache_entry entries[OIJSON_CACHE_WAYS];// a single set
+        char bytes[OIJSON_CACHE_WAYS * 32];
+        unsigned int locks = 0;
+        oijson_cache cache = oijson_cache_create(entries, OIJSON_CACHE_WAYS, bytes, sizeof(bytes), test_cache_lock, test_cache_unlock, &locks);
+        CHECK_TEST(cache.set_count == 1 && cache.slot_size == 32, 1);
+
+        const char first[] = " {\"flag\" : true} ";
+        char copy[sizeof(first)];
+        for (unsigned int i = 0; i < sizeof(first); i++) {
+            copy[i] = first[i];
+        }
+        oijson json = oijson_cache_parse(&cache, first, sizeof(first));
+        CHECK_TEST(json.type == oijson_type_object && locks == 2, 1);// lookup and insert
+        json = oijson_cache_parse(&cache, copy, sizeof(copy));
+        CHECK_TEST(json.type == oijson_type_object && json.buffer == copy + 1 && json.size == 15 && locks == 3, 1);// hit, rebased onto copy
+        CHECK_TEST(oijson_object_value_by_name(json, "flag").type == oijson_type_true, 1);
+
+        CHECK_TEST(oijson_cache_parse(&cache, "[1,", 3).type == oijson_type_invalid && locks == 4, 1);// errors are not cached
+        CHECK_TEST(oijson_cache_parse(&cache, "[1,", 3).type == oijson_type_invalid && locks == 5, 1);
+
+        const char* others[] = { "1", "2", "3", "4" };
+        for (unsigned int i = 0; i < 3; i++) {
+            oijson_cache_parse(&cache, others[i], 1);
+        }
+        locks = 0;
+        oijson_cache_parse(&cache, first, sizeof(first));// touch first, so "1" is the least recently used
+        oijson_cache_parse(&cache, others[3], 1);
+        CHECK_TEST(locks == 3, 1);
+        oijson_cache_parse(&cache, first, sizeof(first));
+        CHECK_TEST(locks == 4, 1);// still cached
+        oijson_cache_parse(&cache, others[0], 1);
+        CHECK_TEST(locks == 6, 1);// evicted
+
+        for (unsigned int i = 0; i < OIJSON_CACHE_WAYS; i++) {// same hash and size, other bytes: a hit must match the stored copy
+            if (entries[i].json_size == 1 && bytes[i * 32] == '1') {
+                bytes[i * 32] = '5';
+            }
+        }
+        locks = 0;
+        CHECK_TEST(oijson_cache_parse(&cache, others[0], 1).type == oijson_type_number && locks == 2, 1);
+
+        for (unsigned int i = 0; i < OIJSON_CACHE_WAYS; i++) {// stamps about to wrap around keep their order
+            entries[i].stamp = 0xFFFFFFFFu - (entries[i].json_size == sizeof(first) ? 0 : 1 + i);
+        }
+        oijson_cache_parse(&cache, others[0], 1);// renumbers the set instead of wrapping "1" around to the oldest stamp
+        for (unsigned int i = 0; i < 2; i++) {
+            oijson_cache_parse(&cache, i ? "[6]" : "[5]", 3);
+        }
+        locks = 0;
+        oijson_cache_parse(&cache, others[0], 1);
+        CHECK_TEST(locks == 1 && entries[0].stamp < 16, 1);
+
+        CHECK_TEST(oijson_cache_create(entries, OIJSON_CACHE_WAYS - 1, bytes, sizeof(bytes), 0, 0, 0).set_count == 0, 1);
+        CHECK_TEST(oijson_cache_create(entries, OIJSON_CACHE_WAYS, bytes, OIJSON_CACHE_WAYS - 1, 0, 0, 0).set_count == 0, 1);
+        locks = 0;
+        char large[40] = "[0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]";// larger than a slot, never cached
+        CHECK_TEST(oijson_cache_parse(&cache, large, string_length(large)).type == oijson_type_array && locks == 0, 1);
+        oijson_cache disabled = oijson_cache_create(0, 0, 0, 0, 0, 0, 0);
+        CHECK_TEST(oijson_cache_parse(&disabled, first, sizeof(first)).type == oijson_type_object, 1);
+        report_partial_tests("cache");
+    }
+
+    {// MERGE PATCH
+        CHECK_TEST(test_merge_patch("{\"a\":\"b\"}", "{\"a\":\"c\"}", "{\"a\":\"c\"}"), 1);// RFC 7386 appendix A
+        CHECK_TEST(test_merge_patch("{\"a\":\"b\"}", "{\"b\":\"c\"}", "{\"a\":\"b\",\"b\":\"c\"}"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":\"b\"}", "{\"a\":null}", "{}"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}", "{\"b\":\"c\"}"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":[\"b\"]}", "{\"a\":\"c\"}", "{\"a\":\"c\"}"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":\"c\"}", "{\"a\":[\"b\"]}", "{\"a\":[\"b\"]}"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}", "{\"a\":{\"b\":\"d\"}}"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}", "{\"a\":[1]}"), 1);
+        CHECK_TEST(test_merge_patch("[\"a\",\"b\"]", "[\"c\",\"d\"]", "[\"c\",\"d\"]"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":\"b\"}", "[\"c\"]", "[\"c\"]"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":\"foo\"}", "null", "null"), 1);
+        CHECK_TEST(test_merge_patch("{\"a\":\"foo\"}", "\"bar\"", "\"bar\""), 1);
+        CHECK_TEST(test_merge_patch("{\"e\":null}", "{\"a\":1}", "{\"e\":null,\"a\":1}"), 1);
+        CHECK_TEST(test_merge_patch("[1,2]", "{\"a\":\"b\",\"c\":null}", "{\"a\":\"b\"}"), 1);
+        CHECK_TEST(test_merge_patch("{}", "{\"a\":{\"bb\":{\"ccc\":null}}}", "{\"a\":{\"bb\":{}}}"), 1);
+
+        CHECK_TEST(test_merge_patch("{ \"keep\" : [1, 2],  \"x\" : 1 }", "{\"x\":2}", "{\"keep\" : [1, 2],\"x\":2}"), 1);// untouched members are copied as is
+        CHECK_TEST(test_merge_patch("{\"a\\u0062\":1}", "{\"ab\":2}", "{\"a\\u0062\":2}"), 1);// names are compared decoded
+
+        pretty_sink sink;
+        sink.size = 0;
+        sink.calls = 0;
+        const char* target = "{\"a\":1}";
+        const char* patch = "{\"b\":2}";
+        CHECK_TEST(oijson_merge_patch_write(oijson_parse(target, 7), oijson_parse(patch, 7), pretty_sink_write, &sink) && string_equal(sink.buffer, "{\"a\":1,\"b\":2}"), 1);
+        char small[8];
+        CHECK_TEST(oijson_merge_patch(oijson_parse(target, 7), oijson_parse(patch, 7), small, sizeof(small)), 0);
+
+        char many_target[512];// patch objects with more names than are hashed
+        char many_patch[512];
+        char many_expected[512];
+        unsigned int target_size = (unsigned int)sprintf(many_target, "{");
+        unsigned int patch_size = (unsigned int)sprintf(many_patch, "{");
+        unsigned int expected_size = (unsigned int)sprintf(many_expected, "{");
+        for (int i = 0; i < 40; i++) {
+            target_size += (unsigned int)sprintf(many_target + target_size, "%s\"t%d\":%d", i ? "," : "", i, i);
+            patch_size += (unsigned int)sprintf(many_patch + patch_size, "%s\"t%d\":%s", i ? "," : "", 39 - i, i % 2 ? "null" : "0");
+            if (i % 2) {
+                expected_size += (unsigned int)sprintf(many_expected + expected_size, "%s\"t%d\":0", i > 1 ? "," : "", i);
+            }
+        }
+        sprintf(many_target + target_size, "}");
+        sprintf(many_patch + patch_size, "}");
+        sprintf(many_expected + expected_size, "}");
+        CHECK_TEST(test_merge_patch(many_target, many_patch, many_expected), 1);
+        report_partial_tests("merge patch");
+    }
+
+    {// JSON PATCH
+        CHECK_TEST(test_json_patch("{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/baz\",\"value\":\"qux\"}]", "{\"foo\":\"bar\",\"baz\":\"qux\"}"), 1);// RFC 6902 appendix A
+        CHECK_TEST(test_json_patch("{\"foo\":[\"bar\",\"baz\"]}", "[{\"op\":\"add\",\"path\":\"/foo/1\",\"value\":\"qux\"}]", "{\"foo\":[\"bar\",\"qux\",\"baz\"]}"), 1);
+        CHECK_TEST(test_json_patch("{\"baz\":\"qux\",\"foo\":\"bar\"}", "[{\"op\":\"remove\",\"path\":\"/baz\"}]", "{\"foo\":\"bar\"}"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":[\"bar\",\"qux\",\"baz\"]}", "[{\"op\":\"remove\",\"path\":\"/foo/1\"}]", "{\"foo\":[\"bar\",\"baz\"]}"), 1);
+        CHECK_TEST(test_json_patch("{\"baz\":\"qux\",\"foo\":\"bar\"}", "[{\"op\":\"replace\",\"path\":\"/baz\",\"value\":\"boo\"}]", "{\"baz\":\"boo\",\"foo\":\"bar\"}"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":{\"bar\":\"baz\",\"waldo\":\"fred\"},\"qux\":{\"corge\":\"grault\"}}", "[{\"op\":\"move\",\"from\":\"/foo/waldo\",\"path\":\"/qux/thud\"}]",
+            "{\"foo\":{\"bar\":\"baz\"},\"qux\":{\"corge\":\"grault\",\"thud\":\"fred\"}}"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":[\"all\",\"grass\",\"cows\",\"eat\"]}", "[{\"op\":\"move\",\"from\":\"/foo/1\",\"path\":\"/foo/3\"}]", "{\"foo\":[\"all\",\"cows\",\"eat\",\"grass\"]}"), 1);
+        CHECK_TEST(test_json_patch("{\"baz\":\"qux\",\"foo\":[\"a\",2,\"c\"]}", "[{\"op\":\"test\",\"path\":\"/baz\",\"value\":\"qux\"},{\"op\":\"test\",\"path\":\"/foo/1\",\"value\":2}]",
+            "{\"baz\":\"qux\",\"foo\":[\"a\",2,\"c\"]}"), 1);
+        CHECK_TEST(test_json_patch("{\"baz\":\"qux\"}", "[{\"op\":\"test\",\"path\":\"/baz\",\"value\":\"bar\"}]", 0), 1);
+        CHECK_TEST(string_equal(oijson_error(), "test failed"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/child\",\"value\":{\"grandchild\":{}}}]", "{\"foo\":\"bar\",\"child\":{\"grandchild\":{}}}"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/baz\",\"value\":\"qux\",\"xyz\":123}]", "{\"foo\":\"bar\",\"baz\":\"qux\"}"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":\"bar\"}", "[{\"op\":\"add\",\"path\":\"/baz/bat\",\"value\":\"qux\"}]", 0), 1);
+        CHECK_TEST(string_equal(oijson_error(), "path not found"), 1);
+        CHECK_TEST(test_json_patch("{\"/\":9,\"~1\":10}", "[{\"op\":\"test\",\"path\":\"/~01\",\"value\":10}]", "{\"/\":9,\"~1\":10}"), 1);
+        CHECK_TEST(test_json_patch("{\"foo\":[\"bar\"]}", "[{\"op\":\"add\",\"path\":\"/foo/-\",\"value\":[\"abc\",\"def\"]}]", "{\"foo\":[\"bar\",[\"abc\",\"def\"]]}"), 1);
+        CHECK_TEST(test_json_patch("[1,2]", "[{\"op\":\"add\",\"path\":\"/3\",\"value\":3}]", 0), 1);// past the end
+
+        CHECK_TEST(test_json_patch("{\"a\":{\"b\":1},\"c\":[]}", "[{\"op\":\"copy\",\"from\":\"/a\",\"path\":\"/c/0\"},{\"op\":\"move\",\"from\":\"/a/b\",\"path\":\"/a\"}]",
+            "{\"a\":1,\"c\":[{\"b\":1}]}"), 1);// a move may replace the value it came from
+        CHECK_TEST(test_json_patch("[0,1,2,3]", "[{\"op\":\"move\",\"from\":\"/3\",\"path\":\"/0\"},{\"op\":\"move\",\"from\":\"/1\",\"path\":\"/-\"}]", "[3,1,2,0]"), 1);
+        CHECK_TEST(test_json_patch("{\"a\":[1,[2]]}", "[{\"op\":\"move\",\"from\":\"/a/0\",\"path\":\"/a/0/1\"}]", 0), 1);// shifted onto the nested array
+        CHECK_TEST(test_json_patch("{\"a\":{\"b\":1}}", "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/a/c\"}]", 0), 1);// into itself
+        CHECK_TEST(test_json_patch("{\"a\":1}", "[{\"op\":\"replace\",\"path\":\"\",\"value\":[true]},{\"op\":\"add\",\"path\":\"/0\",\"value\":\"x\\\"y\"}]", "[\"x\\\"y\",true]"), 1);
+        CHECK_TEST(test_json_patch("{\"a\":1}", "[{\"op\":\"add\",\"path\":\"/q\\\"~1\",\"value\":2}]", "{\"a\":1,\"q\\\"/\":2}"), 1);// new names are escaped
+        CHECK_TEST(test_json_patch("{\"a\":1}", "[{\"op\":\"frob\",\"path\":\"/a\"}]", 0), 1);
+        CHECK_TEST(test_json_patch("{\"a\":1}", "[{\"op\":\"remove\",\"path\":\"a\"}]", 0), 1);
+        CHECK_TEST(test_json_patch("{ \"keep\" : [1, 2], \"x\" : 1 }", "[]", "{ \"keep\" : [1, 2], \"x\" : 1 }"), 1);
+
+        char out[16];
+        const char* target = "{\"a\":[1,2]}";
+        const char* patch = "[{\"op\":\"remove\",\"path\":\"/a/0\"},{\"op\":\"remove\",\"path\":\"/a/0\"}]";
+        CHECK_TEST(oijson_json_patch(oijson_parse(target, 11), oijson_parse(patch, string_length(patch)), out, sizeof(out), 0, 0), 0);// two documents need scratch
+        report_partial_tests("json patch");
+    }
+
+    {// DOM
+        CHECK_TEST(sizeof(oijson_node) == 16, 1);
+        oijson_node nodes[32];
+        oijson_dom dom = oijson_dom_create(nodes, 32);
+        const char dom_str[] = " {\"id\" : 7, \"tags\" : [\"a\", \"b\\n\", [], {}], \"pos\" : {\"x\" : -1.5, \"y\" : 2e1}, \"ok\" : true} ";
+        CHECK_TEST(oijson_dom_build(&dom, dom_str, sizeof(dom_str)), 1);
+        CHECK_TEST(dom.count == 17, 1);// the root, 4 names and values, 4 elements of tags, 2 names and values of pos
+
+        const oijson_node* root = oijson_dom_root(&dom);
+        CHECK_TEST(root->type == oijson_type_object && oijson_dom_count(root) == 4, 1);
+        CHECK_TEST(oijson_dom_value_by_name(&dom, root, "id")->data.real == 7.0, 1);
+        const oijson_node* pos = oijson_dom_member(&dom, root, 2);
+        CHECK_TEST(oijson_dom_value_by_name(&dom, pos, "x")->data.real == -1.5 && oijson_dom_value_by_name(&dom, pos, "y")->data.real == 20.0, 1);
+        CHECK_TEST(oijson_dom_value_by_name(&dom, pos, "z") == 0, 1);
+        CHECK_TEST(oijson_dom_member(&dom, root, 3)->type == oijson_type_true, 1);
+        CHECK_TEST(oijson_dom_member(&dom, root, 4) == 0, 1);
+
+        const oijson_node* tags = oijson_dom_value_by_name(&dom, root, "tags");
+        CHECK_TEST(oijson_dom_count(tags) == 4 && oijson_dom_count(oijson_dom_element(&dom, tags, 2)) == 0, 1);
+        char tag[8];
+        CHECK_TEST(oijson_value_as_string(oijson_dom_value(&dom, oijson_dom_element(&dom, tags, 1)), tag, sizeof(tag)) && string_equal(tag, "b\n"), 1);
+        CHECK_TEST(oijson_value_as_string(oijson_dom_value(&dom, oijson_dom_name(&dom, root, 1)), tag, sizeof(tag)) && string_equal(tag, "tags"), 1);
+        oijson pos_json = oijson_dom_value(&dom, pos);
+        CHECK_TEST(pos_json.type == oijson_type_object && pos_json.size == 23, 1);
+        CHECK_TEST(oijson_dom_value(&dom, root).size == sizeof(dom_str) - 3 && oijson_dom_value(&dom, tags).size == 20, 1);// ends found through the last children
+        CHECK_TEST(oijson_dom_value(&dom, oijson_dom_element(&dom, tags, 3)).size == 2 && oijson_dom_value(&dom, oijson_dom_value_by_name(&dom, pos, "y")).size == 3, 1);
+
+        CHECK_TEST(oijson_dom_build(&dom, "[1, 2, 3]", 9) && dom.count == 4, 1);// memory is reused
+        CHECK_TEST(oijson_dom_element(&dom, oijson_dom_root(&dom), 2)->data.real == 3.0, 1);
+        CHECK_TEST(oijson_dom_build(&dom, "[[1,[2,[]]],{\"a\":[3]},4]", 24) && dom.count == 11, 1);// nested blocks, packed after the root
+        const oijson_node* nested = oijson_dom_element(&dom, oijson_dom_element(&dom, oijson_dom_element(&dom, oijson_dom_root(&dom), 0), 1), 0);
+        CHECK_TEST(nested->data.real == 2.0 && oijson_dom_element(&dom, oijson_dom_value_by_name(&dom, oijson_dom_element(&dom, oijson_dom_root(&dom), 1), "a"), 0)->data.real == 3.0, 1);
+        CHECK_TEST(oijson_dom_element(&dom, oijson_dom_root(&dom), 2)->data.real == 4.0 && oijson_dom_value(&dom, oijson_dom_element(&dom, oijson_dom_root(&dom), 1)).size == 9, 1);
+        CHECK_TEST(oijson_dom_value(&dom, oijson_dom_element(&dom, oijson_dom_root(&dom), 0)).size == 10 && oijson_dom_value(&dom, oijson_dom_root(&dom)).size == 24, 1);
+        oijson_number exact;
+        CHECK_TEST(oijson_dom_build(&dom, "[1e999999999999, 9007199254740993]", 34) && oijson_value_as_number(oijson_dom_value(&dom, oijson_dom_element(&dom, oijson_dom_root(&dom), 1)), &exact), 1);
+        CHECK_TEST(exact.number_class == oijson_number_class_integer && exact.integer == 9007199254740993LL && oijson_dom_element(&dom, oijson_dom_root(&dom), 0)->data.real > 1e308, 1);// decoded on demand, exact past 2^53
+        CHECK_TEST(oijson_dom_build(&dom, " \"s\" ", 5) && dom.count == 1 && oijson_dom_value(&dom, oijson_dom_root(&dom)).size == 3, 1);
+        CHECK_TEST(oijson_dom_build(&dom, "[1, 2,]", 7), 0);
+        CHECK_TEST(oijson_dom_root(&dom) == 0, 1);
+
+        oijson_dom small = oijson_dom_create(nodes, 3);
+        CHECK_TEST(oijson_dom_build(&small, "[1, 2, 3]", 9), 0);
+        CHECK_TEST(string_equal(oijson_error(), "not enough nodes"), 1);
+        report_partial_tests("dom");
+    }
+
+    {// KEYSET
+        const char* names[] = { "id", "name", "caf\xc3\xa9", "tags", "a\"b", "" };
+        oijson_keyset_slot slots[16];
+        oijson_keyset keyset = oijson_keyset_create(names, 6, slots, 15);// rounded down to 8 slots
+        CHECK_TEST(keyset.slot_count == 8, 1);
+
+        const char* json = "{\"tags\":[],\"unknown\":1,\"\\u0069d\":2,\"caf\\u00e9\":3,\"a\\\"b\":4,\"\":5,\"nam\":6,\"names\":7}";
+        int ids[8];
+        int count = 0;
+        oijson_iterator iterator = oijson_iterator_create(oijson_parse(json, string_length(json)));
+        while (iterator.type != oijson_iterator_type_invalid && count < 8) {
+            ids[count++] = oijson_keyset_find(&keyset, iterator.name);
+            oijson_iterator_advance(&iterator);
+        }
+        CHECK_TEST(count == 8 && ids[0] == 3 && ids[1] == -1 && ids[2] == 0 && ids[3] == 2, 1);
+        CHECK_TEST(ids[4] == 4 && ids[5] == 5 && ids[6] == -1 && ids[7] == -1, 1);
+        CHECK_TEST(oijson_keyset_find(&keyset, oijson_parse("1", 1)), -1);
+        CHECK_TEST(oijson_keyset_find(&keyset, oijson_object_name_by_index(oijson_parse(json, string_length(json)), 4)), 4);
+
+        const char* duplicates[] = { "x", "y", "x" };// reuses the slots of keyset
+        CHECK_TEST(oijson_keyset_create(duplicates, 3, slots, 16).slot_count == 0, 1);
+        CHECK_TEST(string_equal(oijson_error(), "duplicate name: x"), 1);
+        CHECK_TEST(oijson_keyset_create(names, 6, slots, 6).slot_count == 0, 1);// 4 slots
+        report_partial_tests("keyset");
+    }
+
+    {// CURSOR
+        const char* json = "{\"a\":1,\"b\":[10,20,30],\"c\":\"x\"}";
+        oijson root = oijson_parse(json, string_length(json));
+        oijson_cursor cursor = oijson_cursor_create(root);
+        CHECK_TEST(cursor.count == OIJSON_CURSOR_COUNT_UNKNOWN && oijson_cursor_count(&cursor) == 3 && cursor.index == 0, 1);// counting does not move the cursor
+        CHECK_TEST(oijson_cursor_value_by_index(&cursor, 1).type == oijson_type_array && cursor.index == 1, 1);
+        CHECK_TEST(oijson_cursor_name_by_index(&cursor, 1).buffer[1] == 'b' && cursor.index == 1, 1);
+        CHECK_TEST(oijson_cursor_name_by_index(&cursor, 2).buffer[1] == 'c' && cursor.index == 2, 1);// resumed
+        CHECK_TEST(oijson_cursor_value_by_index(&cursor, 0).buffer[0] == '1' && cursor.index == 0, 1);// restarted
+        CHECK_TEST(oijson_cursor_value_by_index(&cursor, 3).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_cursor_value_by_index(&cursor, 2).type == oijson_type_string, 1);
+
+        oijson_cursor elements = oijson_cursor_create(oijson_cursor_value_by_index(&cursor, 1));
+        long sum = 0;
+        for (unsigned int i = 0; i < oijson_cursor_count(&elements); i++) {
+            long l = 0;
+            oijson_value_as_long(oijson_cursor_value_by_index(&elements, i), &l);
+            sum += l;
+        }
+        CHECK_TEST(sum == 60 && elements.count == 3, 1);
+        CHECK_TEST(oijson_cursor_value_by_index(&elements, 5).type == oijson_type_invalid, 1);
+        CHECK_TEST(oijson_cursor_name_by_index(&elements, 0).type == oijson_type_invalid, 1);// elements have no names
+
+        oijson_cursor scalar = oijson_cursor_create(oijson_parse("1", 1));
+        CHECK_TEST(oijson_cursor_count(&scalar) == 0 && oijson_cursor_value_by_index(&scalar, 0).type == oijson_type_invalid, 1);
+        report_partial_tests("cursor");
+    }
+
+    {// FIND ALL BY KEY
+        const char* json = "{\"id\":1,\"note\":\"\\\"id\\\":2, not a key\",\"list\":[\"id\",{\"i\\u0064\" : {\"id\":[3]}},{\"idx\":4}],\"ids\":{\"id\":\"5\"}} {\"id\":6}";
+        oijson found[4];
+        unsigned int count = 0;
+        oijson root = oijson_parse_lazy(json, string_length(json));// scanning stops at the end of the root
+        CHECK_TEST(oijson_find_all_by_key(root, "id", found, 4, &count) && count == 4, 1);
+        CHECK_TEST(found[0].type == oijson_type_number && found[0].buffer[0] == '1', 1);
+        CHECK_TEST(found[1].type == oijson_type_object && found[1].size == 10 && found[2].type == oijson_type_array, 1);// nested in each other
+        CHECK_TEST(found[3].type == oijson_type_string && found[3].buffer[1] == '5', 1);
+        CHECK_TEST(oijson_find_all_by_key(root, "id", found, 2, &count) == 0 && count == 4, 1);// counts past out_size
+        CHECK_TEST(oijson_find_all_by_key(root, "missing", 0, 0, &count) && count == 0, 1);
+        CHECK_TEST(oijson_find_all_by_key(root, "idx", found, 4, &count) && count == 1 && found[0].buffer[0] == '4', 1);
+        CHECK_TEST(oijson_find_all_by_key(oijson_parse("\"id\"", 4), "id", found, 4, &count) && count == 0, 1);
+        report_partial_tests("find all by key");
+    }
+
+    {// PROJECT
+        const char* record = "{ \"id\" : 7, \"user\" : { \"name\" : \"ada\", \"mail\" : \"a@b\", \"tags\" : [ 1, 2 ] }, \"items\" : [ {\"sku\":\"x\",\"n\":1}, {\"sku\":\"y\",\"n\":2} ], \"a/b\" : 1, \"m~n\" : 2 }";
+        const char* paths_id_name[] = { "/id", "/user/name" };
+        const char* paths_nested[] = { "/items/1/sku", "/user/tags", "/user/tags/0" };
+        const char* paths_escaped[] = { "/a~1b", "/m~0n", "/items/01", "/missing/x" };
+        const char* paths_whole[] = { "/id", "" };
+        const char* paths_invalid[] = { "id", "/a~2" };
+        const char* paths_kept[] = { "/a" };
+        CHECK_TEST(test_project(record, paths_id_name, 2, "{\"id\":7,\"user\":{\"name\":\"ada\"}}"), 1);
+        CHECK_TEST(test_project(record, paths_nested, 3, "{\"user\":{\"tags\":[1,2]},\"items\":[{\"sku\":\"y\"}]}"), 1);// kept values are minified too
+        CHECK_TEST(test_project(record, paths_escaped, 4, "{\"a/b\":1,\"m~n\":2}"), 1);
+        CHECK_TEST(test_project(record, paths_escaped + 2, 2, "{}"), 1);
+        CHECK_TEST(test_project("[{\"a\":1},{\"b\":2}]", paths_nested, 0, "[]"), 1);
+        CHECK_TEST(test_project("{\"user\":1,\"id\":2}", paths_id_name, 2, "{\"id\":2}"), 1);// a number has no name
+        CHECK_TEST(test_project("{\"n\\u0061me\":1}", paths_id_name + 1, 1, "{}"), 1);
+        CHECK_TEST(test_project("{\"user\":{\"n\\u0061me\":1}}", paths_id_name + 1, 1, "{\"user\":{\"n\\u0061me\":1}}"), 1);// names are compared decoded
+        CHECK_TEST(test_project("{\"id\":1, \"x\":\" \\\" 2 \"}", paths_whole, 2, "{\"id\":1,\"x\":\" \\\" 2 \"}"), 1);// strings keep their whitespace
+        CHECK_TEST(test_project("{\"a\":[ 1 , 2 ], \"b\":3}", paths_kept, 1, "{\"a\":[1,2]}"), 1);
+        CHECK_TEST(test_project("{\"id\":1}", paths_invalid, 1, ""), 0);
+        CHECK_TEST(test_project("{\"a\\u0000\":1}", paths_invalid + 1, 1, ""), 0);// '~' must be followed by '0' or '1'
+        CHECK_TEST(test_project("1", paths_id_name, 1, ""), 0);
+
+        pretty_sink sink;
+        sink.size = 0;
+        sink.calls = 0;
+        CHECK_TEST(oijson_project_write(oijson_parse(record, string_length(record)), paths_id_name, 2, pretty_sink_write, &sink) && string_equal(sink.buffer, "{\"id\":7,\"user\":{\"name\":\"ada\"}}"), 1);
+        char small[8];
+        CHECK_TEST(oijson_project(oijson_parse(record, string_length(record)), paths_id_name, 2, small, sizeof(small)), 0);
+        report_partial_tests("project");
+    }
+
+    {// CANONICAL HASH AND EQUALITY
+        const char* pairs[][2] = {
+            { "{\"a\":1,\"b\":[1,2.0,\"A\"],\"c\":{\"x\":null,\"y\":true}}", " { \"c\" : {\"y\":true, \"x\":null}, \"b\" : [1.0, 2, \"\\u0041\"], \"\\u0061\" : 10e-1 } " },
+            { "[0, 0.5, 1500]", "[-0, 5e-1, 1.5E3]" },
+            { "\"\\ud834\\udd1e\\n\"", "\"\xf0\x9d\x84\x9e\\u000A\"" },
+            { "123456789012345678901234567890", "1234567890123456789012345678900e-1" },// exact, not rounded to a double
+            { "{\"a\":1,\"a\":2}", "{\"a\":2.0,\"a\":1}" },// repeated names match pair for pair
+            { "[0.00, 100e-2, 1e99999999999999999999]", "[-0e5, 1, 1.0e+0099999999999999999999]" },
+            { "[1,2]", "[2,1]" },
+            { "{\"a\":1,\"a\":1}", "{\"a\":1,\"b\":2}" },
+            { "1e400", "2e400" },
+            { "0.1", "0.10000000000000000001" },
+            { "1e99999999999999999999", "1e99999999999999999998" },
+            { "{\"a\":1,\"b\":2}", "{\"a\":2,\"b\":1}" },
+            { "{\"a\":1}", "{\"a\":1,\"b\":1}" },
+            { "{\"a\":{\"b\":1}}", "{\"a\":{\"c\":1}}" },
+            { "\"1\"", "1" },
+            { "[[]]", "[[],[]]" },
+            { "null", "false" },
+        };
+        int results[17];
+        for (int i = 0; i < 17; i++) {
+            oijson a = oijson_parse(pairs[i][0], string_length(pairs[i][0]));
+            oijson b = oijson_parse(pairs[i][1], string_length(pairs[i][1]));
+            unsigned long long hash_a = 0;
+            unsigned long long hash_b = 1;
+            int hashed = oijson_hash(a, &hash_a) && oijson_hash(b, &hash_b);
+            int equal = oijson_equal(a, b);
+            results[i] = hashed && (hash_a == hash_b) == equal && oijson_equal(b, a) == equal ? equal : -1;// hashes agree with equality, both ways
+        }
+        CHECK_TEST(results[0] == 1 && results[1] == 1 && results[2] == 1 && results[3] == 1 && results[4] == 1 && results[5] == 1, 1);
+        CHECK_TEST(results[6] || results[7] || results[8] || results[9] || results[10] || results[11] || results[12] || results[13] || results[14] || results[15] || results[16], 0);
+        CHECK_TEST(oijson_hash(oijson_parse("[1,]", 4), 0), 0);
+        CHECK_TEST(oijson_equal(oijson_parse("[1,]", 4), oijson_parse("[1,]", 4)), 0);
+        CHECK_TEST(oijson_equal(oijson_parse("1e2", 3), oijson_parse("100", 3)), 1);
+
+        char many_a[512];
+        char many_b[512];
+        for (int count = 32; count <= 40; count += 8) {// hashed, then past the hash slots
+            unsigned int size_a = (unsigned int)sprintf(many_a, "{");
+            unsigned int size_b = (unsigned int)sprintf(many_b, "{");
+            for (int i = 0; i < count; i++) {
+                size_a += (unsigned int)sprintf(many_a + size_a, "%s\"k%d\":%d", i ? "," : "", i % 30, i);
+                size_b += (unsigned int)sprintf(many_b + size_b, "%s\"k%d\":%d", i ? "," : "", (count - 1 - i) % 30, count - 1 - i);
+            }
+            sprintf(many_a + size_a++, "}");
+            sprintf(many_b + size_b++, "}");
+            CHECK_TEST(oijson_equal(oijson_parse(many_a, size_a), oijson_parse(many_b, size_b)), 1);
+            many_b[size_b - 2] = '9';// the last value of b changes
+            CHECK_TEST(oijson_equal(oijson_parse(many_a, size_a), oijson_parse(many_b, size_b)), 0);
+        }
+        report_partial_tests("canonical hash and equality");
+    }
+
+    {// PARSE MANY
+        const char* jsons[] = { "{\"a\":[1,2]}", "[1,]", " \"s\" ", "-0.5", "{\"a\" 1}" };
+        unsigned int sizes[] = { 11, 4, 5, 4, 8 };
+        oijson out[5];
+        CHECK_TEST(oijson_parse_many(jsons, sizes, 5, out) == 3, 1);// two fail
+        CHECK_TEST(out[0].type == oijson_type_object && out[1].type == oijson_type_invalid && out[4].type == oijson_type_invalid, 1);
+        CHECK_TEST(out[2].type == oijson_type_string && out[2].size == 3 && out[3].type == oijson_type_number, 1);
+        CHECK_TEST(oijson_parse_many(jsons, sizes, 0, out) == 0, 1);
+        CHECK_TEST(oijson_parse_many(0, sizes, 5, out) == 0, 1);
+        report_partial_tests("parse many");
+    }
+
+    {// CHUNKED PARSE
+        const char* jsons[] = {
+            "{\"a\":[1,2,{\"b\":\"x,y]\\\"}\"}],\"c\":true,\"d\\u00e9\":null,\"e\":-1.5e3}",
+            "[ \"\\ud83d\\ude00\", \"tab\\\\t\", {\"k\" : [[], {}], \"s\": \"\xC3\xA9:{\"}, 0 ]",
+            "\"just a string, with [brackets] and: commas\"",
+            "  123  ",
+            "{\"a\":1}\0garbage]]\"",
+            " [\"a\" , \"b\",\"\\\\\",\"\\\"\"] ",
+        };
+        const unsigned int sizes[] = { 0, 0, 0, 0, 18, 0 };
+        const char replacements[] = { '\"', '\\', '[', ']', '{', '}', ',', ':', ' ', '\0', 'x', '1' };
+        char buffer[96];
+        int agree = 1;
+        for (unsigned int i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+            unsigned int size = sizes[i] ? sizes[i] : string_length(jsons[i]);
+            agree = agree && test_chunked(jsons[i], size);
+            for (unsigned int cut = 0; cut < size; cut++) {// every truncation, and every byte replaced by a few others
+                agree = agree && test_chunked(jsons[i], cut);
+                for (unsigned int r = 0; r < sizeof(replacements); r++) {
+                    for (unsigned int j = 0; j < size; j++) {
+                        buffer[j] = j == cut ? replacements[r] : jsons[i][j];
+                    }
+                    agree = agree && test_chunked(buffer, size);
+                }
+            }
+        }
+        CHECK_TEST(agree, 1);
+
+        char deep[2 * 1025 + 1];
+        for (unsigned int i = 0; i < 1025; i++) {
+            deep[i] = i % 2 ? '[' : '{';
+        }
+        CHECK_TEST(test_chunked(deep, 1025), 1);// too deep
+        for (unsigned int i = 0; i < 1024; i++) {
+            deep[i] = '[';
+            deep[1024 + i] = ']';
+        }
+        CHECK_TEST(test_chunked(deep, 2048) && oijson_parse(deep, 2048).type == oijson_type_array, 1);
+        deep[0] = ' ';
+        deep[2047] = ' ';
+        deep[2048] = '[';
+        CHECK_TEST(test_chunked(deep + 1, 2048), 1);// one more level is too deep
+        CHECK_TEST(oijson_parse(deep + 1, 2048).type, oijson_type_invalid);
+
+        const char* escape = "[\"\\                ";
+        int same_error = 1;
+        for (unsigned int count = 1; count <= 8; count++) {// an invalid escape before a cut fails with the error of oijson_parse
+            same_error = same_error && oijson_parse_chunked(escape, 19, test_chunks, count).type == oijson_type_invalid &&
+                string_equal(oijson_error(), "invalid escaped control character");
+        }
+        CHECK_TEST(same_error, 1);
+        CHECK_TEST(oijson_parse_chunked(escape, 3, test_chunks, 2).type == oijson_type_invalid && string_equal(oijson_error(), "unexpected end of json string"), 1);
+
+        const char* json = "[\"a,b\",{\"c\":[1]}] x";
+        unsigned int count = oijson_chunk_split(json, 20, test_chunks, 4);
+        CHECK_TEST(count == 4 && test_chunks[1].buffer[0] == ',', 1);// cut before delimiters, even inside strings
+        for (unsigned int i = 0; i < count; i++) {
+            oijson_chunk_scan(&test_chunks[i]);
+        }
+        CHECK_TEST(oijson_chunk_stitch(test_chunks, count) == count, 1);
+        CHECK_TEST(oijson_chunk_result(test_chunks, count).type == oijson_type_invalid && string_equal(oijson_error(), "chunk not validated"), 1);
+        for (unsigned int i = 0; i < count; i++) {
+            oijson_chunk_validate(&test_chunks[i]);
+        }
+        CHECK_TEST(oijson_chunk_result(test_chunks, count).type == oijson_type_invalid && string_equal(oijson_error(), "unexpected character after value"), 1);
+        CHECK_TEST(oijson_chunk_split(0, 4, test_chunks, 4) == 0 && oijson_chunk_split(json, 4, 0, 4) == 0, 1);
+        report_partial_tests("chunked parse");
+    }
+
+    {// NUMBER RECORDS
+        CHECK_TEST(test_number_class("0", oijson_number_class_integer), 1);
+        CHECK_TEST(test_number_class("-42", oijson_number_class_integer), 1);
+        CHECK_TEST(test_number_class("9223372036854775807", oijson_number_class_integer), 1);
+        CHECK_TEST(test_number_class("-9223372036854775808", oijson_number_class_integer), 1);
+        CHECK_TEST(test_number_class("9223372036854775808", oijson_number_class_big), 1);
+        CHECK_TEST(test_number_class("1.5", oijson_number_class_real), 1);
+        CHECK_TEST(test_number_class("1e2", oijson_number_class_real), 1);
+        CHECK_TEST(test_number_class("0.123456789012345678", oijson_number_class_big), 1);
+        CHECK_TEST(test_number_class("0.000000000000000001", oijson_number_class_real), 1);// padding zeros are not significant
+        CHECK_TEST(test_number_class("1.000000000000000000", oijson_number_class_real), 1);
+        CHECK_TEST(test_number_class("1e400", oijson_number_class_big), 1);// beyond the double range
+        CHECK_TEST(test_number_class("-1e-400", oijson_number_class_big), 1);
+        CHECK_TEST(test_number_class("0e400", oijson_number_class_real), 1);
+
+        oijson_number number;
+        long l = 0;
+        int i = 0;
+        double d = 0.0;
+        CHECK_TEST(oijson_value_as_number(oijson_parse("-9223372036854775808", 20), &number) && number.integer == -9223372036854775807LL - 1, 1);
+        CHECK_TEST(oijson_value_as_number(oijson_parse("123456", 6), &number) && oijson_number_as_long(&number, &l) && l == 123456, 1);
+        CHECK_TEST(oijson_number_as_int(&number, &i) && i == 123456 && oijson_number_as_double(&number, &d) && d == 123456.0, 1);
+        CHECK_TEST(oijson_value_as_number(oijson_parse("-2.5e1", 6), &number) && number.real == -25.0 && oijson_number_as_long(&number, &l) && l == -25, 1);
+        CHECK_TEST(oijson_value_as_number(oijson_parse("0.1", 3), &number) && number.real == 0.1, 1);// correctly rounded
+        CHECK_TEST(oijson_value_as_number(oijson_parse("1e-300", 6), &number) && number.real > 0.999999999999999e-300 && number.real < 1.000000000000001e-300, 1);// approximate
+        CHECK_TEST(oijson_value_as_number(oijson_parse("123.456e-5", 10), &number) && number.real == 123.456e-5, 1);
+        CHECK_TEST(oijson_value_as_number(oijson_parse("1e30", 4), &number) && number.number_class == oijson_number_class_real, 1);
+        CHECK_TEST(oijson_number_as_long(&number, &l), 0);// out of range
+        CHECK_TEST(oijson_value_as_number(oijson_parse("3000000000", 10), &number) && oijson_number_as_int(&number, &i), 0);
+        CHECK_TEST(oijson_value_as_number(oijson_parse("\"1\"", 3), &number), 0);
+        CHECK_TEST(oijson_parse("1.5e35", 5).type == oijson_type_number && oijson_parse("-05", 2).type == oijson_type_number, 1);// ends at size
+        report_partial_tests("number records");
+    }
+
+    {// NUMBER ARRAYS
+        const char doubles_str[] = "[1.5, -2.25 ,10.5e-3,0, 1e+2 ]";
+        oijson array = oijson_parse(doubles_str, sizeof(doubles_str));
+        double doubles[5];
+        unsigned int count;
+        CHECK_TEST(oijson_array_as_doubles(array, doubles, 5, &count), 1);
+        CHECK_TEST(count == 5, 1);
+        for (unsigned int i = 0; i < count; i++) {// same values as single conversions
+            double d;
+            oijson_value_as_double(oijson_array_value_by_index(array, i), &d);
+            CHECK_TEST(doubles[i] == d, 1);
+        }
+        CHECK_TEST(doubles[4] == 100.0, 1);
+
+        float floats[5];
+        CHECK_TEST(oijson_array_as_floats(array, floats, 5, &count), 1);
+        CHECK_TEST(count == 5 && floats[0] == 1.5f && floats[1] == -2.25f, 1);
+
+        CHECK_TEST(oijson_array_as_doubles(array, doubles, 4, &count), 0);// fails - buffer too small
+        CHECK_TEST(count == 4, 1);
+
+        const char longs_str[] = "[0, -0.51, 19.51e-1, 10.51e7, -7]";
+        array = oijson_parse(longs_str, sizeof(longs_str));
+        long longs[5];
+        CHECK_TEST(oijson_array_as_longs(array, longs, 5, &count), 1);
+        CHECK_TEST(count == 5 && longs[0] == 0 && longs[1] == -1 && longs[2] == 2 && longs[3] == 110000000 && longs[4] == -7, 1);
+
+        int ints[5];
+        CHECK_TEST(oijson_array_as_ints(array, ints, 5, &count), 1);
+        CHECK_TEST(count == 5 && ints[4] == -7, 1);
+
+        const char mixed_str[] = "[1, 2, \"3\", 4]";
+        array = oijson_parse(mixed_str, sizeof(mixed_str));
+        CHECK_TEST(oijson_array_as_ints(array, ints, 5, &count), 0);// fails - third element is not a number
+        CHECK_TEST(count == 2 && ints[0] == 1 && ints[1] == 2, 1);
+
+        CHECK_TEST(oijson_array_as_ints(oijson_parse(" [ ] ", 5), ints, 5, &count), 1);
+        CHECK_TEST(count == 0, 1);
+        CHECK_TEST(oijson_array_as_ints(oijson_parse("{}", 2), ints, 5, &count), 0);// fails - not an array
+        report_partial_tests("number arrays");
+    }
+
+    {// COLUMNS
+        const char records_str[] = "[{\"ts\":1,\"user\":\"a\",\"value\":0.5},{\"value\":1.5,\"ts\":2},{\"ts\":3,\"user\":null,\"value\":2.5,\"other\":[]}]";
+        oijson records = oijson_parse(records_str, sizeof(records_str));
+
+        long ts[3];
+        oijson user[3];
+        double value[3];
+        unsigned char user_present[1] = { 0 };
+        unsigned char value_present[1] = { 0 };
+        oijson_column columns[] = {
+            { "ts", oijson_field_type_long, ts, 0 },
+            { "user", oijson_field_type_value, user, user_present },
+            { "value", oijson_field_type_double, value, value_present },
+        };
+        unsigned int rows;
+        CHECK_TEST(oijson_array_extract_columns(records, columns, 3, 3, &rows), 1);
+        CHECK_TEST(rows == 3, 1);
+        CHECK_TEST(ts[0] == 1 && ts[1] == 2 && ts[2] == 3, 1);
+        CHECK_TEST(value[0] == 0.5 && value[1] == 1.5 && value[2] == 2.5, 1);
+        CHECK_TEST(value_present[0] == 7, 1);
+        CHECK_TEST(user_present[0] == 1, 1);// missing in the second row, null in the third
+        CHECK_TEST(user[0].type == oijson_type_string && user[1].type == oijson_type_invalid && user[2].type == oijson_type_invalid, 1);
+
+        CHECK_TEST(oijson_array_extract_columns(records, columns, 3, 2, &rows), 0);// fails - not enough rows
+        CHECK_TEST(rows == 2, 1);
+
+        const char mistyped_str[] = "[{\"ts\":1},{\"ts\":\"2\"}]";
+        CHECK_TEST(oijson_array_extract_columns(oijson_parse(mistyped_str, sizeof(mistyped_str)), columns, 3, 3, &rows), 0);// fails - string in a number column
+        CHECK_TEST(rows == 1, 1);
+
+        const char escaped_str[] = "[{\"t\\u0073\":4}]";
+        CHECK_TEST(oijson_array_extract_columns(oijson_parse(escaped_str, sizeof(escaped_str)), columns, 1, 3, &rows), 1);
+        CHECK_TEST(rows == 1 && ts[0] == 4, 1);
+        report_partial_tests("columns");
+    }
+
+    {// BIND
+        const char person_str[] = "{\"age\":44,\"unknown\":[1,2],\"name\":\"Jack\",\"active\":true,\"address\":{\"zip\":1234,\"city\":\"Rome\"},\"tags\":[\"a\"]}";
+        test_person person;
+        person.height = -1.0;
+        CHECK_TEST(oijson_bind(oijson_parse(person_str, sizeof(person_str)), test_person_fields, sizeof(test_person_fields) / sizeof(test_person_fields[0]), &person), 1);
+        CHECK_TEST(string_equal(person.name, "Jack") && person.age == 44 && person.active == 1, 1);
+        CHECK_TEST(person.height == -1.0, 1);// optional field left untouched
+        CHECK_TEST(string_equal(person.address.city, "Rome") && person.address.zip == 1234, 1);
+        CHECK_TEST(person.tags.type == oijson_type_array, 1);
+
+        CHECK_TEST(test_bind("{\"name\":\"Jack\",\"age\":44,\"height\":1.8,\"active\":false,\"address\":{\"city\":\"Rome\"}}", 1), 1);
+        CHECK_TEST(test_bind("{\"name\":\"Jack\",\"active\":false,\"address\":{\"city\":\"Rome\"}}", 0), 1);// missing age
+        CHECK_TEST(test_bind("{\"name\":\"Jack\",\"age\":null,\"active\":false,\"address\":{\"city\":\"Rome\"}}", 0), 1);// null age
+        CHECK_TEST(test_bind("{\"name\":\"Jack\",\"age\":\"44\",\"active\":false,\"address\":{\"city\":\"Rome\"}}", 0), 1);// mistyped age
+        CHECK_TEST(test_bind("{\"name\":\"Jack\",\"age\":44,\"active\":0,\"address\":{\"city\":\"Rome\"}}", 0), 1);// mistyped active
+        CHECK_TEST(test_bind("{\"name\":\"Jack\",\"age\":44,\"active\":false,\"address\":{}}", 0), 1);// missing nested city
+        CHECK_TEST(test_bind("{\"name\":\"Jack Smith\",\"age\":44,\"active\":false,\"address\":{\"city\":\"Rome\"}}", 0), 1);// name too long
+        CHECK_TEST(test_bind("[]", 0), 1);
+
+        oijson_bind(oijson_parse("{}", 2), test_person_fields, 1, &person);
+        CHECK_TEST(string_equal(oijson_error(), "missing field: name"), 1);
+
+        char wide_names[70][4];
+        oijson_field wide_fields[70];
+        int wide_values[70];
+        char wide_str[1024];
+        unsigned int wide_size = (unsigned int)sprintf(wide_str, "{\"f66\":null");// past the first 64 fields, a later value counts
+        for (int i = 0; i < 70; i++) {
+            sprintf(wide_names[i], "f%d", i);
+            wide_fields[i] = (oijson_field){ wide_names[i], oijson_field_type_int, (unsigned int)(i * (int)sizeof(int)), 0, 0, 0, 0 };
+            wide_size += (unsigned int)sprintf(wide_str + wide_size, ",\"f%d\":%d", 69 - i, 69 - i);
+        }
+        sprintf(wide_str + wide_size++, "}");
+        CHECK_TEST(oijson_bind(oijson_parse(wide_str, wide_size), wide_fields, 70, wide_values) && wide_values[0] == 0 && wide_values[66] == 66 && wide_values[69] == 69, 1);
+        sprintf(wide_names[66], "g66");
+        CHECK_TEST(oijson_bind(oijson_parse(wide_str, wide_size), wide_fields, 70, wide_values), 0);
+        CHECK_TEST(string_equal(oijson_error(), "missing field: g66"), 1);
+        report_partial_tests("bind");
+    }
+
     print_test_results("TOTAL", tests_passed, tests_count);
 
     return 0;
@@ -0,0 +1,408 @@
+#include <cstdio>
+#include <exception>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include "oijson.hpp"
+
+#if defined(OIJSON_COROUTINES) && __has_include(<unistd.h>)
+#define TEST_ASYNC_FDS 1
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+struct point {
+    double x;
+    double y;
+};
+
+struct shape {
+    char name[8];
+    int sides;
+    bool closed;
+    point origin;
+    oijson::value tags;
+    long weight;
+};
+
+template <>
+struct oijson::fields<point> {
+    static constexpr auto list = std::make_tuple(
+        oijson::field("x", &point::x),
+        oijson::field("y", &point::y)
+    );
+};
+
+template <>
+struct oijson::fields<shape> {
+    static constexpr auto list = std::make_tuple(
+        oijson::field("name", &shape::name),
+        oijson::field("sides", &shape::sides),
+        oijson::field("closed", &shape::closed),
+        oijson::field("origin", &shape::origin),
+        oijson::field("tags", &shape::tags, true),
+        oijson::field("weight", &shape::weight, true)
+    );
+};
+
+static int tests_passed = 0;
+static int tests_count = 0;
+static int tests_passed_partial = 0;
+static int tests_count_partial = 0;
+
+static void check_test(int test_result, int expected_result) {
+    printf("test returned %d, and %d was expected ", test_result, expected_result);
+    tests_count++;
+    tests_count_partial++;
+    if (test_result == expected_result) {
+        tests_passed++;
+        tests_passed_partial++;
+        puts("[PASSED]");
+        return;
+    }
+    puts("[FAILED]");
+}
+
+#define CHECK_TEST(test_result, expected_result) do { printf("(Ln %d)", __LINE__); check_test(test_result, expected_result); } while(0)
+
+static void print_test_results(const char* tag, int passed, int total) {
+    printf("\nTEST RESULTS(%s): %.2d/%.2d passed(%d failed)\n\n", tag, passed, total, total - passed);
+}
+
+static void report_partial_tests(const char* tag) {
+    print_test_results(tag, tests_passed_partial, tests_count_partial);
+    tests_passed_partial = 0;
+    tests_count_partial = 0;
+}
+
+static int test_split(std::string_view stream, oijson::split mode, std::size_t chunk, std::size_t capacity, int expected_count) {
+    printf("SPLIT TEST: input: %.*s -> ", static_cast<int>(stream.size()), stream.data());
+    char buffer[64];
+    oijson::stream_splitter splitter(buffer, capacity < sizeof(buffer) ? capacity : sizeof(buffer), mode);
+    int count = 0;
+    while (!splitter.failed() && !splitter.done()) {
+        std::size_t size = stream.size() < chunk ? stream.size() : chunk;
+        std::size_t fed = splitter.feed(stream.substr(0, size));
+        stream.remove_prefix(fed);
+        if (stream.empty()) {
+            splitter.finish();
+        }
+        for (oijson::value v = splitter.next(); v; v = splitter.next()) {
+            count++;
+        }
+    }
+    printf("%d values%s%s\n", count, splitter.failed() ? ", error: " : "", splitter.failed() ? splitter.error() : "");
+    return splitter.failed() ? -1 : count == expected_count;
+}
+
+#ifdef OIJSON_COROUTINES
+struct detached {// coroutine that starts right away and is never awaited
+    struct promise_type {
+        detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct id_totals {
+    int count = 0;
+    long sum = 0;
+    bool ended = false;
+};
+
+static detached sum_ids(oijson::async_parser& parser, id_totals& totals) {
+    for (;;) {
+        oijson::value v = co_await parser.next();
+        if (!v) {
+            break;
+        }
+        long id = 0;
+        totals.count++;
+        totals.sum += v["id"].get(id) ? id : 0;
+    }
+    totals.ended = true;
+}
+#endif
+
+#ifdef TEST_ASYNC_FDS
+static void pump(int fd, oijson::async_parser& parser, std::size_t chunk) {// what an event loop does when fd is readable
+    while (parser.waiting()) {
+        char* space = parser.space();
+        ssize_t size = read(fd, space, parser.space_size() < chunk ? parser.space_size() : chunk);
+        if (size <= 0) {
+            parser.finish();
+            return;
+        }
+        parser.commit(static_cast<std::size_t>(size));
+    }
+}
+
+static int test_async_fd(bool socket, std::size_t chunk) {
+    printf("ASYNC TEST: %s, %zu byte reads -> ", socket ? "socketpair" : "pipe", chunk);
+    constexpr std::string_view stream = "{\"id\":1}\n{\"id\":20,\"tags\":[\"]\"]}\n{ \"id\" : 300 }\n";
+    int fds[2];
+    if ((socket ? socketpair(AF_UNIX, SOCK_STREAM, 0, fds) : pipe(fds)) != 0) {
+        puts("could not create file descriptors");
+        return 0;
+    }
+    int written = write(fds[1], stream.data(), stream.size()) == static_cast<ssize_t>(stream.size());
+    close(fds[1]);
+
+    char buffer[32];
+    oijson::async_parser parser(buffer, sizeof(buffer));
+    id_totals totals;
+    sum_ids(parser, totals);// suspends until bytes arrive
+    int suspended = parser.waiting() && totals.count == 0;
+    pump(fds[0], parser, chunk);
+    close(fds[0]);
+    printf("%d values, sum %ld\n", totals.count, totals.sum);
+    return written && suspended && totals.ended && parser.done() && totals.count == 3 && totals.sum == 321;
+}
+#endif
+
+// Checked while compiling, the build fails if any of these does not hold.
+constexpr oijson::literal config(R"({ "name" : "server", "port" : 8080, "ratio" : 2.5e-1, "n\u00e9" : true,
+    "hosts" : [ "a", "b", { "id" : 3 } ], "empty" : {} })");
+static_assert(config.is_object() && config.size() == 6);
+static_assert(config["name"].raw() == "\"server\"");
+static_assert(config["port"].value_or(0) == 8080);
+static_assert(config["ratio"].value_or(0.0) == 0.25);
+static_assert(config["n\xC3\xA9"].value_or(false));// escaped key
+static_assert(config["hosts"].size() == 3 && config["hosts"][2u]["id"].value_or(0) == 3);
+static_assert(config["hosts"][1u].value_or(std::string_view()) == "b");
+static_assert(!config["missing"].valid() && config["port"].value_or(std::string_view("none")) == "none");
+static_assert(config["empty"].size() == 0 && !config["hosts"][3u].valid());
+static_assert(oijson::literal(" [1,\n2] ").raw() == "[1,\n2]");
+static_assert(oijson::literal("9e30").value_or(-1L) == -1L && oijson::literal("2147483648").value_or(-1) == -1);// out of range, as in oijson.c
+static_assert(oijson::is_valid("[\"\\ud83d\\ude00\"]") && !oijson::is_valid("[\"\\ud83d\"]"));
+static_assert(!oijson::is_valid("{\"a\":1,}") && !oijson::is_valid("01") && !oijson::is_valid("[1] x"));
+
+static int test_bind(std::string_view json, int expected_result) {
+    printf("BIND TEST: input: %.*s -> ", static_cast<int>(json.size()), json.data());
+    shape s{};
+    int result = oijson::bind(oijson::value::parse(json), s);
+    puts(result ? "bound" : "not bound");
+    return result == expected_result;
+}
+
+int main() {
+    {// VIEWS
+        constexpr std::string_view json = R"({ "a" : 1, "b\"c" : [true, "x", null], "d" : { "e" : -2.5 } })";
+        oijson::value root = oijson::value::parse(json);
+        CHECK_TEST(root.is_object(), 1);
+        CHECK_TEST(root["a"].is_number(), 1);
+        CHECK_TEST(root["b\"c"].is_array(), 1);// escaped key
+        CHECK_TEST(root["missing"].valid(), 0);
+        CHECK_TEST(root["d"]["e"].raw() == "-2.5", 1);
+
+        double e = 0.0;
+        CHECK_TEST(root["d"]["e"].get(e) && e == -2.5, 1);
+        int a = 0;
+        CHECK_TEST(root["a"].get(a) && a == 1, 1);
+        oijson::c::oijson_number number{};
+        CHECK_TEST(root["d"]["e"].get(number) && number.number_class == oijson::c::oijson_number_class_real && number.real == -2.5, 1);
+        bool flag = false;
+        CHECK_TEST(root["b\"c"][0u].get(flag) && flag, 1);
+        std::string_view x;
+        CHECK_TEST(root["b\"c"][1u].get(x) && x == "x", 1);
+        CHECK_TEST(root["b\"c"][2u].is_null(), 1);
+
+        const std::string_view keys[] = { "a", "b\\\"c", "d" };
+        int index = 0;
+        int keys_match = 1;
+        for (const oijson::member& m : root.members()) {
+            keys_match = keys_match && m.key == keys[index];
+            index++;
+        }
+        CHECK_TEST(keys_match && index == 3, 1);
+
+        int count = 0;
+        for (oijson::value v : root["b\"c"].elements()) {
+            count += v.valid();
+        }
+        CHECK_TEST(count, 3);
+
+        count = 0;
+        for (oijson::value v : root["a"].elements()) {// not an array
+            count += v.valid();
+        }
+        CHECK_TEST(count, 0);
+
+        oijson::value lazy = oijson::value::parse_lazy(R"({"id":7,"rest":[1,,]})");
+        CHECK_TEST(lazy["id"].get(a) && a == 7, 1);
+        CHECK_TEST(lazy.validate(), 0);
+        report_partial_tests("views");
+    }
+
+    {// BIND
+        constexpr std::string_view json = R"({"sides":4,"name":"square","unknown":{},"closed":true,"origin":{"y":2,"x":1},"tags":["a"],"weight":null})";
+        shape s{};
+        s.weight = 7;
+        CHECK_TEST(oijson::bind(oijson::value::parse(json), s), 1);
+        CHECK_TEST(std::string_view(s.name) == "square" && s.sides == 4 && s.closed, 1);
+        CHECK_TEST(s.origin.x == 1.0 && s.origin.y == 2.0, 1);
+        CHECK_TEST(s.tags.is_array(), 1);
+        CHECK_TEST(s.weight == 7, 1);// null leaves optional fields untouched
+
+        CHECK_TEST(test_bind(R"({"name":"tri","sides":3,"closed":false,"origin":{"x":0,"y":0}})", 1), 1);
+        CHECK_TEST(test_bind(R"({"n\u0061me":"tri","sides":3,"closed":false,"origin":{"x":0,"y":0}})", 1), 1);// escaped key
+        CHECK_TEST(test_bind(R"({"name":"tri","closed":false,"origin":{"x":0,"y":0}})", 0), 1);// missing sides
+        CHECK_TEST(test_bind(R"({"name":"tri","sidez":3,"closed":false,"origin":{"x":0,"z":0,"y":0}})", 0), 1);// unknown keys of field lengths
+        CHECK_TEST(test_bind(R"({"name":"tri","sides":"3","closed":false,"origin":{"x":0,"y":0}})", 0), 1);// mistyped sides
+        CHECK_TEST(test_bind(R"({"name":"triangle","sides":3,"closed":false,"origin":{"x":0,"y":0}})", 0), 1);// name too long
+        CHECK_TEST(test_bind(R"({"name":"tri","sides":3,"closed":false,"origin":{"x":0}})", 0), 1);// missing nested y
+        CHECK_TEST(test_bind("[]", 0), 1);
+        report_partial_tests("bind");
+    }
+
+    {// LITERAL
+        const std::string_view cases[] = {
+            "{}", "[]", " 0 ", "-0.5e+3", "1.", "-", "01", ".5", "1e", "\"\\u00e9\"", "\"\\uDC00\"", "\"\\x\"",
+            "\"\xC3\xA9\"", "\"\xC3\"", "\"\xC0\x80\"", "\"\xF5\x80\x80\x80\"", "\"tab\t\"", "[1,[2,{\"a\":[]}]]", "[1 2]",
+            "{\"a\" 1}", "{\"a\":}", "[true,false,null]", "[tru]", "nul", "[1]]", "{\"a\":1}\n", "[", "\"",
+        };
+        int agree = 1;
+        for (std::string_view json : cases) {
+            oijson::c::oijson parsed = oijson::c::oijson_parse(json.data(), static_cast<unsigned int>(json.size()));
+            bool accepted = parsed.type != oijson::c::oijson_type_invalid;
+            agree = agree && oijson::is_valid(json) == accepted && oijson::literal(json).valid() == accepted;
+            agree = agree && (!accepted || oijson::literal(json).raw() == std::string_view(parsed.buffer, parsed.size));
+        }
+        CHECK_TEST(agree, 1);
+
+        const std::string_view numbers[] = { "12", "-7.5", "7.5", "2.6", "1e3", "15e-1", "-123.456e2", "0.1", "1e400", "1e-400" };
+        agree = 1;
+        for (std::string_view json : numbers) {
+            oijson::value v = oijson::value::parse(json);
+            double d = 0.0;
+            long l = 0;
+            long literal_l = 0;
+            agree = agree && v.get(d) && oijson::literal(json).value_or(-1.0) == d;
+            agree = agree && v.get(l) == oijson::literal(json).get(literal_l) && l == literal_l;// 1e400 is out of range for both
+        }
+        CHECK_TEST(agree, 1);
+
+        oijson::value v = config.to_value()["hosts"][2u];
+        int id = 0;
+        CHECK_TEST(v.is_object() && v["id"].get(id) && id == 3, 1);
+        CHECK_TEST(oijson::literal("[1,").valid(), 0);// not constant evaluated, so invalid JSON is an invalid literal
+        report_partial_tests("literal");
+    }
+
+    {// BATCH
+        constexpr std::string_view documents[] = { R"({"id":1,"v":[1,2]})", "[]", R"({"id":2,)", "\"x\"", " 7 ", "{\"a\":{\"b\":null}}" };
+        constexpr std::size_t count = 600;
+        static std::string_view jsons[count];
+        static oijson::value out[count];
+        for (std::size_t i = 0; i < count; i++) {
+            jsons[i] = documents[i % 6];
+        }
+
+        oijson::batch batch(jsons, out, count, 16);
+        std::size_t per_thread[4] = {};
+        std::thread threads[4];
+        for (std::size_t t = 0; t < 4; t++) {
+            threads[t] = std::thread([&batch, &per_thread, t] { per_thread[t] = batch.work(); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        CHECK_TEST(batch.valid() == 500 && per_thread[0] + per_thread[1] + per_thread[2] + per_thread[3] == 500, 1);
+        int matches = 1;
+        for (std::size_t i = 0; i < count; i++) {
+            matches = matches && out[i].valid() == (i % 6 != 2) && (!out[i].valid() || out[i].raw().data() >= jsons[i].data());
+        }
+        CHECK_TEST(matches, 1);
+        CHECK_TEST(out[4].raw() == "7" && out[7].raw() == "[]", 1);
+
+        oijson::value::parse("[1,]");
+        char error[128];
+        std::strncpy(error, oijson::c::oijson_error(), sizeof(error) - 1);
+        error[sizeof(error) - 1] = '\0';
+        char other_error[128] = {};
+        std::thread other([&other_error] {// sets its own error string, copied before the thread and its storage go away
+            oijson::value::parse("{\"a\" 1}");
+            std::strncpy(other_error, oijson::c::oijson_error(), sizeof(other_error) - 1);
+        });
+        other.join();
+        CHECK_TEST(std::strcmp(error, oijson::c::oijson_error()) == 0 && other_error[0] && std::strcmp(other_error, error) != 0, 1);
+        report_partial_tests("batch");
+    }
+
+    {// PARALLEL PARSER
+        static char json[1 << 16];
+        std::size_t size = 0;
+        json[size++] = '[';
+        for (int i = 0; size < sizeof(json) - 64; i++) {
+            size += static_cast<std::size_t>(std::snprintf(json + size, 64, "%s{\"id\":%d,\"tag\":\"a,b]\\\"\",\"v\":[%d.5]}\n", i ? "," : "", i, i));
+        }
+        json[size++] = ']';
+        static oijson::c::oijson_chunk chunks[32];
+        const oijson::c::oijson expected = oijson::c::oijson_parse(json, static_cast<unsigned int>(size));
+
+        auto run = [&](std::size_t thread_count) {
+            oijson::parallel_parser parser(std::string_view(json, size), chunks, 32);
+            std::thread threads[4];
+            for (std::size_t i = 0; i < thread_count; i++) {
+                threads[i] = std::thread([&parser] { parser.work(); });
+            }
+            parser.work();// the calling thread helps too
+            for (std::size_t i = 0; i < thread_count; i++) {
+                threads[i].join();
+            }
+            return parser.result();
+        };
+        oijson::value v = run(4);
+        CHECK_TEST(v.is_array() && v.raw().data() == expected.buffer && v.raw().size() == expected.size, 1);
+        CHECK_TEST(run(0).raw().size() == expected.size, 1);
+
+        json[size / 2 + 7] = '}';// somewhere in the middle
+        CHECK_TEST(run(4).valid() || oijson::c::oijson_parse(json, static_cast<unsigned int>(size)).type != oijson::c::oijson_type_invalid, 0);
+
+        oijson::parallel_parser empty(std::string_view(), chunks, 32);
+        empty.work();
+        CHECK_TEST(empty.result().valid(), 0);
+        report_partial_tests("parallel parser");
+    }
+
+    {// STREAM SPLITTER
+        constexpr std::string_view values = "{\"a\":1}\n[1,\"]\"]\n\"str\\\"q\"\n 42 true\n-1.5e3";
+        CHECK_TEST(test_split(values, oijson::split::values, 3, 64, 6), 1);
+        CHECK_TEST(test_split(values, oijson::split::values, 1, 12, 6), 1);// compacted as values are consumed
+        CHECK_TEST(test_split(" [ {\"id\":1}, {\"id\":[2]} ,3 ] [] [4]", oijson::split::elements, 4, 64, 4), 1);
+        CHECK_TEST(test_split("{\"long\":\"value\"}", oijson::split::values, 4, 8, 1), -1);// larger than the buffer
+        CHECK_TEST(test_split("{\"a\":1} {\"a\":}", oijson::split::values, 64, 64, 1), -1);// validated
+        CHECK_TEST(test_split("{\"a\":[1,2]", oijson::split::values, 64, 64, 0), -1);// truncated
+        CHECK_TEST(test_split("[1 2]", oijson::split::elements, 64, 64, 2), -1);
+        CHECK_TEST(test_split("{}", oijson::split::elements, 64, 64, 1), -1);
+        report_partial_tests("stream splitter");
+    }
+
+#ifdef OIJSON_COROUTINES
+    {// ASYNC PARSER
+        char buffer[64];
+        oijson::async_parser parser(buffer, sizeof(buffer), oijson::split::elements);
+        id_totals totals;
+        sum_ids(parser, totals);
+        parser.feed("[{\"id\":");
+        CHECK_TEST(parser.waiting() && totals.count == 0, 1);
+        parser.feed("5},{\"id\":6}");
+        CHECK_TEST(parser.waiting() && totals.count == 2 && totals.sum == 11, 1);
+        parser.feed(",7]");
+        parser.finish();
+        CHECK_TEST(totals.ended && parser.done() && totals.count == 3, 1);
+
+#ifdef TEST_ASYNC_FDS
+        CHECK_TEST(test_async_fd(false, 5), 1);
+        CHECK_TEST(test_async_fd(true, 7), 1);
+#endif
+        report_partial_tests("async parser");
+    }
+#endif
+
+    print_test_results("TOTAL", tests_passed, tests_count);
+
+    return 0;
+}
@@ -5,7 +5,19 @@
 #define OIJSON_STEP_ITR() do { itr++; if (!(*size)) { oijson_internal_error_set("unexpected end of json string"); return OIJSON_NULLCHAR; } (*size)--; } while(0)
 #define OIJSON_CHECK_ITR() do { if(!itr || !(*size)) { oijson_internal_error_set("unexpected end of json string"); return OIJSON_NULLCHAR; } } while(0)
 
-static char oijson_internal_error[128] = "";
+#ifndef OIJSON_THREAD_LOCAL// each thread gets its own error string, define as empty to share one instead
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define OIJSON_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define OIJSON_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define OIJSON_THREAD_LOCAL __thread
+#else
+#define OIJSON_THREAD_LOCAL
+#endif
+#endif
+
+static OIJSON_THREAD_LOCAL char oijson_internal_error[128] = "";
 
 static void oijson_internal_error_set(const char* message) {
     int i = 0;
@@ -20,6 +32,22 @@ static void oijson_internal_error_set(const char* message) {
     oijson_internal_error[i] = '\0';
 }
 
+static void oijson_internal_error_set_field(const char* message, const char* name) {// sets "message: name"
+    oijson_internal_error_set(message);
+    int i = 0;
+    while (oijson_internal_error[i]) {
+        i++;
+    }
+    const char* separator = ": ";
+    while (i < 127 && *separator) {
+        oijson_internal_error[i++] = *separator++;
+    }
+    while (i < 127 && *name) {
+        oijson_internal_error[i++] = *name++;
+    }
+    oijson_internal_error[i] = '\0';
+}
+
 const char* oijson_error(void) {
     return oijson_internal_error;
 }
@@ -43,6 +71,100 @@ static int oijson_internal_is_hex_digit(const char c) {
     return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||(c >= 'a' && c <= 'f');
 }
 
+// SWAR helpers, used to check 8 bytes at a time without relying on SIMD intrinsics
+#define OIJSON_SWAR_ONES 0x0101010101010101ULL
+#define OIJSON_SWAR_HIGHS 0x8080808080808080ULL
+
+static unsigned long long oijson_internal_swar_load(const char* ptr) {
+    const unsigned char* ptr_u = (const unsigned char*)ptr;// written out so compilers merge it into a single load
+    return (unsigned long long)ptr_u[0] | ((unsigned long long)ptr_u[1] << 8) | ((unsigned long long)ptr_u[2] << 16) |
+        ((unsigned long long)ptr_u[3] << 24) | ((unsigned long long)ptr_u[4] << 32) | ((unsigned long long)ptr_u[5] << 40) |
+        ((unsigned long long)ptr_u[6] << 48) | ((unsigned long long)ptr_u[7] << 56);
+}
+
+static void oijson_internal_swar_store(char* ptr, unsigned long long word) {
+    for (int i = 0; i < 8; i++) {
+        ptr[i] = (char)(unsigned char)(word >> (i * 8));
+    }
+}
+
+static unsigned long long oijson_internal_swar_less(unsigned long long word, unsigned char c) {// nonzero if any byte is below c (c <= 128)
+    return (word - OIJSON_SWAR_ONES * c) & ~word & OIJSON_SWAR_HIGHS;
+}
+
+static unsigned long long oijson_internal_swar_equal(unsigned long long word, unsigned char c) {// nonzero if any byte equals c
+    return oijson_internal_swar_less(word ^ (OIJSON_SWAR_ONES * c), 1);
+}
+
+static unsigned long long oijson_internal_swar_zero(unsigned long long word) {// high bit of exactly each zero byte, unlike swar_less
+    return ~(((word & ~OIJSON_SWAR_HIGHS) + ~OIJSON_SWAR_HIGHS) | word) & OIJSON_SWAR_HIGHS;
+}
+
+static unsigned long long oijson_internal_swar_whitespace(unsigned long long word) {// high bit of each whitespace byte
+    return oijson_internal_swar_zero(word ^ (OIJSON_SWAR_ONES * ' ')) | oijson_internal_swar_zero(word ^ (OIJSON_SWAR_ONES * '\n')) |
+        oijson_internal_swar_zero(word ^ (OIJSON_SWAR_ONES * '\t')) | oijson_internal_swar_zero(word ^ (OIJSON_SWAR_ONES * '\r'));
+}
+
+static unsigned long long oijson_internal_swar_transpose(unsigned long long bits) {// transposes an 8x8 bit matrix, bit 8 * i + j to bit 8 * j + i
+    unsigned long long swap = (bits ^ (bits >> 7)) & 0x00AA00AA00AA00AAULL;
+    bits ^= swap ^ (swap << 7);
+    swap = (bits ^ (bits >> 14)) & 0x0000CCCC0000CCCCULL;
+    bits ^= swap ^ (swap << 14);
+    swap = (bits ^ (bits >> 28)) & 0x00000000F0F0F0F0ULL;
+    bits ^= swap ^ (swap << 28);
+    return bits;
+}
+
+static unsigned int oijson_internal_lowest_bit(unsigned long long bits) {// index of the lowest set bit, bits must not be 0
+    static const unsigned char positions[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4, 62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11, 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6,
+    };
+    return positions[((bits & (0 - bits)) * 0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+static unsigned long long oijson_internal_prefix_xor(unsigned long long bits) {// bit i is the parity of bits 0 to i
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+static const char* oijson_internal_find_string_plain_end(const char* itr, unsigned int* size) {// skips printable ascii string content, which needs no decoding
+    while (*size >= 8) {
+        unsigned long long word = oijson_internal_swar_load(itr);
+        if (oijson_internal_swar_equal(word, '\"') | oijson_internal_swar_equal(word, '\\') | oijson_internal_swar_less(word, 0x20) | (word & OIJSON_SWAR_HIGHS)) {
+            break;
+        }
+        itr += 8;
+        *size -= 8;
+    }
+    while (*size && *itr != '\"' && *itr != '\\' && (unsigned char)*itr >= 0x20 && (unsigned char)*itr < 0x80) {
+        itr++;
+        (*size)--;
+    }
+    return itr;
+}
+
+static const char* oijson_internal_find_string_special(const char* itr, unsigned int* size) {// skips string content up to the next '\"' or '\\'
+    while (*size >= 8) {
+        unsigned long long word = oijson_internal_swar_load(itr);
+        if (oijson_internal_swar_equal(word, '\"') | oijson_internal_swar_equal(word, '\\')) {
+            break;
+        }
+        itr += 8;
+        *size -= 8;
+    }
+    while (*size && *itr != '\"' && *itr != '\\') {
+        itr++;
+        (*size)--;
+    }
+    return itr;
+}
+
 static int oijson_internal_validate_utf8(const char* itr, unsigned int size, unsigned int* out_byte_count) {
     if (!itr || !size) {
         oijson_internal_error_set("invalid utf-8");
@@ -105,6 +227,12 @@ static const char* oijson_internal_consume_utf8(const char* itr, unsigned int* s
 
 static const char* oijson_internal_consume_whitespace(const char* itr, unsigned int* size) {
     OIJSON_CHECK_ITR();
+    if (*size >= 8 && oijson_internal_is_whitespace(*itr)) {// indentation, 8 bytes at a time
+        while (*size >= 8 && oijson_internal_swar_whitespace(oijson_internal_swar_load(itr)) == OIJSON_SWAR_HIGHS) {
+            itr += 8;
+            *size -= 8;
+        }
+    }
     while (*size && oijson_internal_is_whitespace(*itr)) {
         OIJSON_STEP_ITR();
     }
@@ -209,13 +337,13 @@ static int oijson_internal_unicode_to_utf8(char** buffer_ptr, unsigned int* buff
                 }
             }
             else {// set continuation bits
-                *byte_ptr |= 1 << 7;
+                *byte_ptr |= (char)(1 << 7);
             }
         }
 
         unsigned int num_bits = required_bytes == 1 ? 7 : (i == 0 ? 7 - required_bytes : 6);
         for(unsigned int b = 0; b < num_bits; b++) {
-            *byte_ptr |= (((codepoint >> shift) & 1) << b);
+            *byte_ptr |= (char)(((codepoint >> shift) & 1) << b);
             shift++;
         }
     }
@@ -247,7 +375,7 @@ static int escaped_unicode_to_bytes(const char** itr_ptr, unsigned int* size_ptr
         if ((i % 2) == 0) {
             v <<= 4;
         }
-        bytes[i / 2] |= v;
+        bytes[i / 2] |= (unsigned char)v;
         (*size_ptr)--;
         (*itr_ptr)++;
     }
@@ -318,7 +446,7 @@ static const char* oijson_internal_parse_char(const char* itr, unsigned int* siz
             break;
         default:
             for (unsigned int i = 0; i < byte_count; i++) {
-                if (*itr >= 0x00 && *itr < 0x1f) {
+                if (*itr >= 0x00 && *itr < 0x20) {
                     oijson_internal_error_set("unescaped control character");
                     return OIJSON_NULLCHAR;
                 }
@@ -340,8 +468,12 @@ static const char* oijson_internal_consume_string(const char* itr, unsigned int*
         return OIJSON_NULLCHAR;
     }
     OIJSON_STEP_ITR();
-    OIJSON_CHECK_ITR();
-    while (*itr != '\"') {
+    while (1) {// only escapes, control characters and utf-8 sequences go through parse_char
+        itr = oijson_internal_find_string_plain_end(itr, size);
+        OIJSON_CHECK_ITR();
+        if (*itr == '\"') {
+            break;
+        }
         itr = oijson_internal_parse_char(itr, size, 0, 0);
         if (!itr) {
             return OIJSON_NULLCHAR;
@@ -380,7 +512,7 @@ static const char* oijson_internal_consume_number_info(const char* itr, unsigned
         }
     }
 
-    if (*itr == '.') {// fraction
+    if (*size && *itr == '.') {// fraction
         OIJSON_STEP_ITR();
         if (out_fraction) {
             *out_fraction = itr;
@@ -421,7 +553,7 @@ static const char* oijson_internal_consume_number_info(const char* itr, unsigned
         }
     }
 
-    if (itr && oijson_internal_is_digit(*itr)) {
+    if (*size && oijson_internal_is_digit(*itr)) {
         oijson_internal_error_set("invalid number");
         return OIJSON_NULLCHAR;
     }
@@ -433,667 +565,4569 @@ static const char* oijson_internal_consume_number(const char* itr, unsigned int*
     return oijson_internal_consume_number_info(itr, size, 0, 0, 0, 0, 0, 0);
 }
 
-static const char* oijson_internal_consume_object(const char*, unsigned int*);
-static const char* oijson_internal_consume_array(const char*, unsigned int*);
-
-static const char* oijson_internal_consume_value(const char* itr, unsigned int* size) {
-    const char*(*functions[])(const char*, unsigned int*) = {
-        oijson_internal_consume_string,
-        oijson_internal_consume_number,
-        oijson_internal_consume_object,
-        oijson_internal_consume_array,
-        oijson_internal_consume_true,
-        oijson_internal_consume_false,
-        oijson_internal_consume_null,
-    };
-    int len = sizeof(functions) / sizeof(functions[0]);
+static oijson_type oijson_internal_type_from_char(char c) {// type of the value starting with c
+    switch (c) {
+        case '\"':
+            return oijson_type_string;
+        case '{':
+            return oijson_type_object;
+        case '[':
+            return oijson_type_array;
+        case 't':
+            return oijson_type_true;
+        case 'f':
+            return oijson_type_false;
+        case 'n':
+            return oijson_type_null;
+        default:
+            return c == '-' || oijson_internal_is_digit(c) ? oijson_type_number : oijson_type_invalid;
+    }
+}
 
-    for (int i = 0; i < len; i++) {
-        unsigned int temp_size = *size;
-        const char* temp_itr = functions[i](itr, &temp_size);
-        if (temp_itr) {
-            *size = temp_size;
-            return temp_itr;
-        }
+static const char* oijson_internal_consume_scalar(const char* itr, unsigned int* size) {// consumes anything but an object or array, itr is at its first character
+    const char* end;
+    switch (oijson_internal_type_from_char(*itr)) {
+        case oijson_type_string:
+            return oijson_internal_consume_string(itr, size);
+        case oijson_type_number:
+            return oijson_internal_consume_number(itr, size);
+        case oijson_type_true:
+            end = oijson_internal_consume_true(itr, size);
+            break;
+        case oijson_type_false:
+            end = oijson_internal_consume_false(itr, size);
+            break;
+        case oijson_type_null:
+            end = oijson_internal_consume_null(itr, size);
+            break;
+        default:
+            end = OIJSON_NULLCHAR;
+            break;
     }
-    oijson_internal_error_set(*size ? "unexpected character" : "unexpected end of json string");
-    return OIJSON_NULLCHAR;
+    if (!end) {
+        oijson_internal_error_set("unexpected character");
+    }
+    return end;
 }
 
-static const char* oijson_internal_consume_name_value_pair(const char* itr, unsigned int* size, const char** name_start, unsigned int* name_size, const char** value_start, unsigned int* value_size) {
+static const char* oijson_internal_consume_name(const char* itr, unsigned int* size) {// consumes a name and the ':' after it
     itr = oijson_internal_consume_whitespace(itr, size);
     OIJSON_CHECK_ITR();
-
-    // read name
-    if (name_start) {
-        *name_start = itr;
-    }
-    if (name_size) {
-        *name_size = *size;
+    if (*itr != '\"') {
+        oijson_internal_error_set("name expected");
+        return OIJSON_NULLCHAR;
     }
     itr = oijson_internal_consume_string(itr, size);
     if (!itr) {
         return OIJSON_NULLCHAR;
     }
-    if (name_size) {
-        *name_size -= *size;
-    }
-
     itr = oijson_internal_consume_whitespace(itr, size);
-    if (!itr) {
-        return OIJSON_NULLCHAR;
-    }
+    OIJSON_CHECK_ITR();
     if (*itr != ':') {
         oijson_internal_error_set("':' expected");
         return OIJSON_NULLCHAR;
     }
-
     OIJSON_STEP_ITR();// skip ':'
-    if (value_start) {
-        *value_start = itr;
-    }
-    if (value_size) {
-        *value_size = *size;
-    }
-    itr = oijson_internal_consume_value(itr, size);
-    if (value_size) {
-        *value_size -= *size;
-    }
     return itr;
 }
 
-static const char* oijson_internal_consume_object(const char* itr, unsigned int* size) {
-    itr = oijson_internal_consume_whitespace(itr, size);
-    OIJSON_CHECK_ITR();
-    if (*itr != '{') {
-        return OIJSON_NULLCHAR;
-    }
-
-    OIJSON_STEP_ITR();// skip '{'
-    itr = oijson_internal_consume_whitespace(itr, size);
-    OIJSON_CHECK_ITR();
-    if (*itr == '}') {
-        OIJSON_STEP_ITR();
-        return itr;
-    }
+// Validates a value without recursion. Each open object or array takes one bit of stack, set for objects, so nesting
+// deeper than stack_size * 8 levels fails instead of overflowing the call stack.
+static const char* oijson_internal_consume_value(const char* itr, unsigned int* size, unsigned char* stack, unsigned int stack_size) {
+    unsigned int max_depth = stack_size > 0x1FFFFFFFu ? 0xFFFFFFFFu : stack_size * 8;
+    unsigned int depth = 0;
 
-    while(1) {
-        itr = oijson_internal_consume_name_value_pair(itr, size, 0, 0, 0, 0);
-        if (!itr) {
-            return OIJSON_NULLCHAR;
-        }
+    while (1) {// a value is expected at itr
         itr = oijson_internal_consume_whitespace(itr, size);
         OIJSON_CHECK_ITR();
-        if (*itr == '}') {
+
+        if (*itr == '{' || *itr == '[') {
+            char close = *itr == '{' ? '}' : ']';
+            if (depth == max_depth) {
+                oijson_internal_error_set("maximum depth exceeded");
+                return OIJSON_NULLCHAR;
+            }
+            unsigned char bit = (unsigned char)(1u << (depth % 8));
+            stack[depth / 8] = (unsigned char)(close == '}' ? stack[depth / 8] | bit : stack[depth / 8] & ~bit);
+            depth++;
+
             OIJSON_STEP_ITR();
+            itr = oijson_internal_consume_whitespace(itr, size);
+            OIJSON_CHECK_ITR();
+            if (*itr != close) {
+                if (close == '}') {
+                    itr = oijson_internal_consume_name(itr, size);
+                    if (!itr) {
+                        return OIJSON_NULLCHAR;
+                    }
+                }
+                continue;
+            }
+            OIJSON_STEP_ITR();// empty object or array
+            depth--;
+        }
+        else {
+            itr = oijson_internal_consume_scalar(itr, size);
+            if (!itr) {
+                return OIJSON_NULLCHAR;
+            }
+        }
+
+        while (1) {// a value was consumed, close finished objects and arrays until the next element
+            if (!depth) {
+                return itr;
+            }
+            int is_object = (stack[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            itr = oijson_internal_consume_whitespace(itr, size);
+            OIJSON_CHECK_ITR();
+            if (*itr == (is_object ? '}' : ']')) {
+                OIJSON_STEP_ITR();
+                depth--;
+                continue;
+            }
+            if (*itr != ',') {
+                oijson_internal_error_set(is_object ? "',' or '}' expected" : "',' or ']' expected");
+                return OIJSON_NULLCHAR;
+            }
+            OIJSON_STEP_ITR();// step over ','
+            if (is_object) {
+                itr = oijson_internal_consume_name(itr, size);
+                if (!itr) {
+                    return OIJSON_NULLCHAR;
+                }
+            }
             break;
         }
-        if (*itr != ',') {
-            oijson_internal_error_set("',' or '}' expected");
+    }
+}
+
+static const char* oijson_internal_skip_string(const char* itr, unsigned int* size) {// skips a string without validating its contents, itr is at the opening '\"'
+    OIJSON_STEP_ITR();
+    while (1) {
+        itr = oijson_internal_find_string_special(itr, size);
+        if (!(*size)) {
+            oijson_internal_error_set("unexpected end of json string");
             return OIJSON_NULLCHAR;
         }
-        OIJSON_STEP_ITR();// step over ','
+        if (*itr == '\"') {
+            itr++;
+            (*size)--;
+            return itr;
+        }
+        OIJSON_STEP_ITR();// '\\'
+        OIJSON_STEP_ITR();// escaped character
     }
-    return itr;
 }
 
-static const char* oijson_internal_consume_array(const char* itr, unsigned int* size) {
-    itr = oijson_internal_consume_whitespace(itr, size);
-    OIJSON_CHECK_ITR();
-    if (*itr != '[') {
-        return OIJSON_NULLCHAR;
+static const char* oijson_internal_skip_container(const char* itr, unsigned int* size) {// skips an object or array by counting brackets, itr is at the opening bracket
+    unsigned int depth = 0;
+    while (*size) {
+        while (*size >= 8) {// skip words holding no quotes or brackets, '[' and ']' are folded into '{' and '}'
+            unsigned long long word = oijson_internal_swar_load(itr);
+            unsigned long long folded = word | (OIJSON_SWAR_ONES * 0x20);
+            if (oijson_internal_swar_equal(word, '\"') | oijson_internal_swar_equal(folded, '{') | oijson_internal_swar_equal(folded, '}')) {
+                break;
+            }
+            itr += 8;
+            *size -= 8;
+        }
+        if (!(*size)) {
+            break;
+        }
+
+        char c = *itr;
+        if (c == '\"') {
+            itr = oijson_internal_skip_string(itr, size);
+            if (!itr) {
+                return OIJSON_NULLCHAR;
+            }
+            continue;
+        }
+        itr++;
+        (*size)--;
+        if (c == '{' || c == '[') {
+            depth++;
+        }
+        else if (c == '}' || c == ']') {
+            depth--;
+            if (!depth) {
+                return itr;
+            }
+        }
     }
+    oijson_internal_error_set("unexpected end of json string");
+    return OIJSON_NULLCHAR;
+}
 
-    OIJSON_STEP_ITR();// step over ']'
+static const char* oijson_internal_skip_value(const char* itr, unsigned int* size, oijson* out) {// finds the type and extent of a value without validating it
     itr = oijson_internal_consume_whitespace(itr, size);
     OIJSON_CHECK_ITR();
-    if (*itr == ']') {
-        OIJSON_STEP_ITR();
-        return itr;
-    }
 
-    while(1) {
-        itr = oijson_internal_consume_value(itr, size);// value
-        if (!itr) {
-            return OIJSON_NULLCHAR;
-        }
-        itr = oijson_internal_consume_whitespace(itr, size);
-        if (!itr) {
-            return OIJSON_NULLCHAR;
-        }
-        OIJSON_CHECK_ITR();
-        if (*itr == ']') {
-            OIJSON_STEP_ITR();
+    const char* start = itr;
+    unsigned int start_size = *size;
+    oijson_type type;
+    switch (*itr) {
+        case '\"':
+            type = oijson_type_string;
+            itr = oijson_internal_skip_string(itr, size);
             break;
+        case '{':
+            type = oijson_type_object;
+            itr = oijson_internal_skip_container(itr, size);
+            break;
+        case '[':
+            type = oijson_type_array;
+            itr = oijson_internal_skip_container(itr, size);
+            break;
+        case 't':
+            type = oijson_type_true;
+            itr = oijson_internal_consume_true(itr, size);
+            break;
+        case 'f':
+            type = oijson_type_false;
+            itr = oijson_internal_consume_false(itr, size);
+            break;
+        case 'n':
+            type = oijson_type_null;
+            itr = oijson_internal_consume_null(itr, size);
+            break;
+        default:// numbers are validated when converted
+            if (*itr != '-' && !oijson_internal_is_digit(*itr)) {
+                oijson_internal_error_set("unexpected character");
+                return OIJSON_NULLCHAR;
+            }
+            type = oijson_type_number;
+            while (*size && (oijson_internal_is_digit(*itr) || *itr == '-' || *itr == '+' || *itr == '.' || *itr == 'e' || *itr == 'E')) {
+                itr++;
+                (*size)--;
+            }
+            break;
+    }
+    if (!itr) {
+        if (type == oijson_type_true || type == oijson_type_false || type == oijson_type_null) {
+            oijson_internal_error_set("unexpected character");
         }
-        if (*itr != ',') {
-            oijson_internal_error_set("',' or ']' expected");
-            return OIJSON_NULLCHAR;
-        }
-        OIJSON_STEP_ITR();// step over ','
+        return OIJSON_NULLCHAR;
     }
+
+    out->buffer = start;
+    out->size = start_size - *size;
+    out->type = type;
     return itr;
 }
 
-oijson oijson_parse(const char* string, unsigned int string_size) {
-    string = oijson_internal_consume_whitespace(string, &string_size);
-    if (!string) {
-        oijson_internal_error_set("invalid string");
-        return OIJSON_INVALID;
+// Two stage validation, after simdjson. Stage 1 classifies 64-byte blocks into bit masks, one bit per byte, and keeps only
+// the positions where a token starts: structural characters and scalars outside strings, and quotes. Stage 2 walks those
+// positions with the grammar of oijson_internal_consume_value, so whitespace and plain string content are never read one byte
+// at a time. Stage 2 only accepts, anything it does not recognise is parsed again by the byte parser, which reports the error
+typedef struct oijson_internal_structurals_s {
+    const char* buffer;
+    unsigned int size;
+    unsigned int block;// offset of the current block
+    unsigned int next_block;
+    unsigned long long bits;// positions left in the current block
+    unsigned long long in_string;// all ones if the previous block ended inside a string
+    unsigned long long escaped;// 1 if the first byte of the next block is escaped
+    unsigned long long scalar;// 1 if the previous block ended inside a scalar
+} oijson_internal_structurals;
+
+static void oijson_internal_structurals_block(oijson_internal_structurals* structurals) {// stage 1, for the block at next_block
+    const char* block = structurals->buffer + structurals->next_block;
+    unsigned int block_size = structurals->size - structurals->next_block;
+    char padded[64];
+    if (block_size < 64) {// the last block is padded with whitespace, which starts no token
+        for (unsigned int i = 0; i < 64; i++) {
+            padded[i] = i < block_size ? block[i] : ' ';
+        }
+        block = padded;
     }
 
-    oijson out_json = OIJSON_INVALID;
-
-    const char*(*consume_functions[])(const char*, unsigned int*) = {
-        oijson_internal_consume_string,
-        oijson_internal_consume_number,
-        oijson_internal_consume_object,
-        oijson_internal_consume_array,
-        oijson_internal_consume_true,
-        oijson_internal_consume_false,
-        oijson_internal_consume_null,
-    };
-    oijson_type types[] = {
-        oijson_type_string,
-        oijson_type_number,
-        oijson_type_object,
-        oijson_type_array,
-        oijson_type_true,
-        oijson_type_false,
-        oijson_type_null,
-    };
-    int len = sizeof(types) / sizeof(types[0]);
-
-    for (int i = 0; i < len; i++) {
-        unsigned int temp_size = string_size;
-        const char* itr = consume_functions[i](string, &temp_size);
-        unsigned int post_size = temp_size;// remainder after consumed object
-        oijson_internal_consume_whitespace(itr, &post_size);
-        if (itr) {
-            if (post_size && *itr) {
-                break;
-            }
-            out_json.buffer = string;
-            out_json.size = string_size - temp_size;
-            out_json.type = types[i];
-            break;
+    // per word, a byte matches c when its low 7 bits plus 0x80 - c carry into the high bit for c and not for c + 1 (and its
+    // own high bit is clear). The sums for several characters are and-ed before the complement, and the high bits of word i
+    // are collected at bit 8 * j + i, so each mask needs one transpose per block instead of a gather per word
+    const unsigned long long low_highs = ~OIJSON_SWAR_HIGHS;
+    unsigned long long quote = 0;
+    unsigned long long backslash = 0;
+    unsigned long long structural = 0;
+    unsigned long long space = 0;// whitespace and control characters
+    unsigned long long special = 0;// control characters and utf-8
+    for (unsigned int i = 0; i < 8; i++) {
+        unsigned long long word = oijson_internal_swar_load(block + i * 8);
+        unsigned long long low = word & low_highs;
+        unsigned long long folded = low | (OIJSON_SWAR_ONES * 0x20);// '[' and ']' fold onto '{' and '}'
+        unsigned long long ascii = ~word & OIJSON_SWAR_HIGHS;
+        unsigned long long control = ~(low + OIJSON_SWAR_ONES * (0x80 - 0x20)) & ascii;
+        quote |= (~((low ^ (OIJSON_SWAR_ONES * '\"')) + low_highs) & ascii) >> (7 - i);
+        backslash |= (~((low ^ (OIJSON_SWAR_ONES * '\\')) + low_highs) & ascii) >> (7 - i);
+        structural |= (~(((folded ^ (OIJSON_SWAR_ONES * '{')) + low_highs) & ((folded ^ (OIJSON_SWAR_ONES * '}')) + low_highs) &
+            ((low ^ (OIJSON_SWAR_ONES * ':')) + low_highs) & ((low ^ (OIJSON_SWAR_ONES * ',')) + low_highs)) & ascii) >> (7 - i);
+        space |= (~(low + OIJSON_SWAR_ONES * (0x80 - 0x21)) & ascii) >> (7 - i);
+        special |= (control | (word & OIJSON_SWAR_HIGHS)) >> (7 - i);
+    }
+    quote = oijson_internal_swar_transpose(quote);
+    backslash = oijson_internal_swar_transpose(backslash);
+    structural = oijson_internal_swar_transpose(structural);
+    space = oijson_internal_swar_transpose(space);
+    special = oijson_internal_swar_transpose(special);
+
+    // characters after an odd run of backslashes are escaped. Subtracting the run starts from the odd bit positions carries
+    // through each run, leaving a bit after runs of odd length
+    const unsigned long long odd_bits = 0xAAAAAAAAAAAAAAAAULL;
+    unsigned long long potential = backslash & ~structurals->escaped;
+    unsigned long long code = (((potential << 1) | odd_bits) - potential) ^ odd_bits;
+    unsigned long long escaped = code ^ (backslash | structurals->escaped);
+    structurals->escaped = (code & backslash) >> 63;
+
+    quote &= ~escaped;
+    unsigned long long in_string = oijson_internal_prefix_xor(quote) ^ structurals->in_string;// from each opening quote up to its closing quote
+    structurals->in_string = 0 - (in_string >> 63);
+
+    unsigned long long other = ~(quote | structural | space | in_string);// scalars, and anything invalid outside strings
+    unsigned long long starts = other & ~((other << 1) | structurals->scalar);
+    structurals->scalar = other >> 63;
+
+    // strings holding escapes, control characters or utf-8 keep those positions, so stage 2 hands them to the byte parser
+    unsigned long long bits = (structural & ~in_string) | quote | starts | ((backslash | special) & in_string);
+    unsigned long long stray = special & space & ~in_string;// control characters outside strings, where no token may start
+    while (stray) {
+        unsigned long long lowest = stray & (0 - stray);
+        char c = block[oijson_internal_lowest_bit(stray)];
+        if (c != '\t' && c != '\n' && c != '\r') {
+            bits |= lowest;
         }
+        stray ^= lowest;
     }
-    return out_json;
+    if (block_size < 64) {
+        bits &= (1ULL << block_size) - 1;
+    }
+    structurals->bits = bits;
+    structurals->block = structurals->next_block;
+    structurals->next_block += block_size < 64 ? block_size : 64;
 }
 
+static int oijson_internal_structurals_next(oijson_internal_structurals* structurals, unsigned int* out) {// stage 2 input, 0 past the last position
+    while (!structurals->bits) {
+        if (structurals->next_block >= structurals->size) {
+            return 0;
+        }
+        oijson_internal_structurals_block(structurals);
+    }
+    *out = structurals->block + oijson_internal_lowest_bit(structurals->bits);
+    structurals->bits &= structurals->bits - 1;
+    return 1;
+}
 
-unsigned int oijson_object_count(oijson object) {
-    if (object.type != oijson_type_object) {
-        oijson_internal_error_set("not an object");
+static int oijson_internal_structurals_string(oijson_internal_structurals* structurals, unsigned int start, unsigned int* end) {// the string opening at start, end is past its closing quote
+    unsigned int position;
+    if (!oijson_internal_structurals_next(structurals, &position)) {
         return 0;
     }
+    if (structurals->buffer[position] == '\"') {// plain string, without control characters
+        *end = position + 1;
+        return 1;
+    }
 
-    unsigned int count = 0;
-    oijson_iterator iterator = oijson_iterator_create(object);
-    while (iterator.type != oijson_iterator_type_invalid) {
-        count++;
-        oijson_iterator_advance(&iterator);
+    unsigned int size = structurals->size - start;
+    const char* itr = oijson_internal_consume_string(structurals->buffer + start, &size);
+    if (!itr) {
+        return 0;
     }
-    return count;
+    *end = (unsigned int)(itr - structurals->buffer);
+    while (position < *end - 1) {// escapes and utf-8 inside the string
+        if (!oijson_internal_structurals_next(structurals, &position)) {
+            return 0;
+        }
+    }
+    return position == *end - 1;
 }
 
-static int oijson_internal_check_value(const char* ptr, unsigned int len, const char* name) {
-    ptr++;
-
-    const char* key = ptr;
-    unsigned int key_size = len - 2;
+static int oijson_internal_structurals_name(oijson_internal_structurals* structurals, unsigned int start, unsigned int* value) {// a name and its ':', value is the next position
+    unsigned int end;
+    unsigned int colon;
+    return structurals->buffer[start] == '\"' && oijson_internal_structurals_string(structurals, start, &end) &&
+        oijson_internal_structurals_next(structurals, &colon) && structurals->buffer[colon] == ':' && oijson_internal_structurals_next(structurals, value);
+}
 
-    unsigned int name_size = 0;
-    {
-        const char* itr = name;
-        while (*itr) {
-            itr++;
-            name_size++;
-        }
+static int oijson_internal_validate_structurals(const char* string, unsigned int string_size, unsigned char* stack, unsigned int stack_size, unsigned int* out_size) {
+    oijson_internal_structurals structurals = {
+        .buffer = string,
+        .size = string_size,
+        .block = 0,
+        .next_block = 0,
+        .bits = 0,
+        .in_string = 0,
+        .escaped = 0,
+        .scalar = 0,
+    };
+    unsigned int max_depth = stack_size > 0x1FFFFFFFu ? 0xFFFFFFFFu : stack_size * 8;
+    unsigned int depth = 0;
+    unsigned int position;
+    unsigned int end;
+    if (!oijson_internal_structurals_next(&structurals, &position)) {
+        return 0;
     }
 
-    while (key_size && name_size) {
-        char parsed_key[5] = { 0, 0, 0, 0, 0 };
-        char* parsed_key_ptr = parsed_key;
-        unsigned int parsed_key_size = 5;
-        char parsed_name[5] = { 0, 0, 0, 0, 0 };
-        char* parsed_name_ptr = parsed_name;
-        unsigned int parsed_name_size = 5;
-
-        key = oijson_internal_parse_char(key, &key_size, &parsed_key_ptr, &parsed_key_size);
-        name = oijson_internal_parse_char(name, &name_size, &parsed_name_ptr, &parsed_name_size);
+    while (1) {// a value starts at position
+        char c = string[position];
+        if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            if (depth == max_depth) {
+                return 0;
+            }
+            unsigned char bit = (unsigned char)(1u << (depth % 8));
+            stack[depth / 8] = (unsigned char)(close == '}' ? stack[depth / 8] | bit : stack[depth / 8] & ~bit);
+            depth++;
 
-        if (!key && !name) {
-            return 1;
+            if (!oijson_internal_structurals_next(&structurals, &position)) {
+                return 0;
+            }
+            if (string[position] != close) {
+                if (close == '}' && !oijson_internal_structurals_name(&structurals, position, &position)) {
+                    return 0;
+                }
+                continue;
+            }
+            end = position + 1;// empty object or array
+            depth--;
         }
-        if (parsed_key_size != parsed_name_size) {
-            return 0;
+        else if (c == '\"') {
+            if (!oijson_internal_structurals_string(&structurals, position, &end)) {
+                return 0;
+            }
         }
-        for(int i = 0; i < 5; i++) {
-            if (!parsed_key[i] || !parsed_name[i]) {
-                break;
+        else {
+            unsigned int size = string_size - position;
+            const char* itr = oijson_internal_consume_scalar(string + position, &size);
+            if (!itr) {
+                return 0;
             }
-            if (parsed_key[i] != parsed_name[i]) {
+            end = (unsigned int)(itr - string);
+            if (end < string_size && !oijson_internal_is_whitespace(string[end]) && string[end] != ',' && string[end] != ']' && string[end] != '}') {
+                return 0;// the scalar is followed by more of the same token
+            }
+        }
+
+        while (1) {// a value ended before end, close finished objects and arrays until the next element
+            if (!depth) {
+                *out_size = end;
+                return !oijson_internal_structurals_next(&structurals, &position) || !string[position];// a null character ends the input
+            }
+            int is_object = (stack[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            if (!oijson_internal_structurals_next(&structurals, &position)) {
+                return 0;
+            }
+            if (string[position] == (is_object ? '}' : ']')) {
+                end = position + 1;
+                depth--;
+                continue;
+            }
+            if (string[position] != ',' || !oijson_internal_structurals_next(&structurals, &position)) {
                 return 0;
             }
+            if (is_object && !oijson_internal_structurals_name(&structurals, position, &position)) {
+                return 0;
+            }
+            break;
         }
     }
-    return !key_size && !name_size;
 }
 
-oijson oijson_object_value_by_name(oijson object, const char* name) {
-    if (object.type != oijson_type_object || !name) {
-        oijson_internal_error_set("not an object");
+static int oijson_internal_iterator_update(oijson_iterator* iterator, int first);
+static int oijson_internal_iterator_start(oijson value, oijson_iterator* iterator);
+static int oijson_internal_iterator_next(oijson_iterator* iterator);
+
+oijson oijson_parse(const char* string, unsigned int string_size) {
+    unsigned char stack[(OIJSON_MAX_DEPTH + 7) / 8];
+    return oijson_parse_with_stack(string, string_size, stack, sizeof(stack));
+}
+
+oijson oijson_parse_with_stack(const char* string, unsigned int string_size, unsigned char* stack, unsigned int stack_size) {
+    string = oijson_internal_consume_whitespace(string, &string_size);
+    if (!string) {
+        oijson_internal_error_set("invalid string");
+        return OIJSON_INVALID;
+    }
+    if (!stack && stack_size) {
+        oijson_internal_error_set("invalid stack");
+        return OIJSON_INVALID;
+    }
+
+    oijson out_json = {
+        .buffer = string,
+        .size = 0,
+        .type = oijson_internal_type_from_char(*string),
+    };
+    if (oijson_internal_validate_structurals(string, string_size, stack, stack_size, &out_json.size)) {
+        return out_json;
+    }
+
+    unsigned int size = string_size;
+    const char* itr = oijson_internal_consume_value(string, &size, stack, stack_size);
+    if (!itr) {
+        return OIJSON_INVALID;
+    }
+    out_json.size = string_size - size;
+    itr = oijson_internal_consume_whitespace(itr, &size);
+    if (size && *itr) {
+        oijson_internal_error_set("unexpected character after value");
+        return OIJSON_INVALID;
+    }
+    return out_json;
+}
+
+// Serial, the library creates no threads. Callers spread batches over cores by giving each thread a slice, which
+// oijson::batch does in C++
+unsigned int oijson_parse_many(const char* const* jsons, const unsigned int* json_sizes, unsigned int count, oijson* out) {
+    if (!jsons || !json_sizes || !out) {
+        oijson_internal_error_set("invalid string");
+        return 0;
+    }
+
+    unsigned char stack[(OIJSON_MAX_DEPTH + 7) / 8];// shared by every document
+    unsigned int valid = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        out[i] = oijson_parse_with_stack(jsons[i], json_sizes[i], stack, sizeof(stack));
+        valid += out[i].type != oijson_type_invalid;
+    }
+    return valid;
+}
+
+// Validation of one document in parts, which can run on several threads. oijson_chunk_split cuts the document before
+// whitespace or structural characters, so only strings can span two chunks: a number, literal, escape sequence or
+// utf-8 sequence cut there would be invalid anyway. The string state at the start of a chunk is not known until the
+// chunks before it are read, so oijson_chunk_scan skims each chunk once for two summaries, as if it started outside
+// and inside a string, recording the brackets it leaves unmatched and its last tokens. oijson_chunk_stitch walks the
+// summaries in order, keeping the one matching the real string state, to find the nesting and grammar state at the
+// start of every chunk. oijson_chunk_validate then checks each chunk from there as oijson_parse would, and
+// oijson_chunk_result combines them. Chunks after a null character ending the document are ignored, as oijson_parse
+// stops there.
+typedef enum oijson_internal_chunk_state_e {// what the grammar allows next
+    oijson_internal_chunk_state_unknown = 0,// not stitched yet
+    oijson_internal_chunk_state_value,
+    oijson_internal_chunk_state_value_or_close,// after '['
+    oijson_internal_chunk_state_name,
+    oijson_internal_chunk_state_name_or_close,// after '{'
+    oijson_internal_chunk_state_colon,
+    oijson_internal_chunk_state_comma_or_close,
+    oijson_internal_chunk_state_end,// the document value is complete
+    oijson_internal_chunk_state_in_name,
+    oijson_internal_chunk_state_in_value,
+} oijson_internal_chunk_state;
+
+typedef enum oijson_internal_chunk_token_e {
+    oijson_internal_chunk_token_none = 0,
+    oijson_internal_chunk_token_object,// '{'
+    oijson_internal_chunk_token_array,// '['
+    oijson_internal_chunk_token_value_end,// '}', ']', a number or a literal
+    oijson_internal_chunk_token_colon,
+    oijson_internal_chunk_token_comma,
+    oijson_internal_chunk_token_string,
+    oijson_internal_chunk_token_string_continued,// a string that started before the chunk
+} oijson_internal_chunk_token;
+
+typedef enum oijson_internal_chunk_status_e {
+    oijson_internal_chunk_status_pending = 0,
+    oijson_internal_chunk_status_valid,
+    oijson_internal_chunk_status_complete,// valid, and the document value ends in it
+    oijson_internal_chunk_status_terminated,// a null character after the document value ends the document in it
+    oijson_internal_chunk_status_invalid,
+    oijson_internal_chunk_status_skipped,// after a chunk that cannot be valid
+} oijson_internal_chunk_status;
+
+static int oijson_internal_bit_get(const unsigned char* bits, unsigned int index) {
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static void oijson_internal_bit_set(unsigned char* bits, unsigned int index, int value) {
+    unsigned char bit = (unsigned char)(1u << (index % 8));
+    bits[index / 8] = (unsigned char)(value ? bits[index / 8] | bit : bits[index / 8] & ~bit);
+}
+
+static int oijson_internal_is_chunk_boundary(char c) {
+    return oijson_internal_is_whitespace(c) || c == '{' || c == '}' || c == '[' || c == ']' || c == ',' || c == ':';
+}
+
+static oijson_internal_chunk_state oijson_internal_chunk_after_value(unsigned int depth) {
+    return depth ? oijson_internal_chunk_state_comma_or_close : oijson_internal_chunk_state_end;
+}
+
+static oijson_internal_chunk_token oijson_internal_chunk_token_before(const char* start, const char* itr, const char* continued_end) {// the token ending before itr, outside strings
+    while (itr != start && oijson_internal_is_whitespace(itr[-1])) {
+        itr--;
+    }
+    if (itr == start) {
+        return oijson_internal_chunk_token_none;
+    }
+    switch (itr[-1]) {
+        case '{':
+            return oijson_internal_chunk_token_object;
+        case '[':
+            return oijson_internal_chunk_token_array;
+        case ':':
+            return oijson_internal_chunk_token_colon;
+        case ',':
+            return oijson_internal_chunk_token_comma;
+        case '\"':
+            return itr - 1 == continued_end ? oijson_internal_chunk_token_string_continued : oijson_internal_chunk_token_string;
+        default:// '}', ']' or the end of a number or literal
+            return oijson_internal_chunk_token_value_end;
+    }
+}
+
+// Skims a chunk for both summaries at once. Every quote flips the string state under both assumptions, so a bracket
+// is outside strings under exactly one of them. A backslash outside strings makes the chunk invalid under that
+// assumption, so it can always be taken as an escape. The last tokens are then read backwards from the end.
+static void oijson_internal_chunk_summarize(const char* buffer, unsigned int size, oijson_chunk_summary* summaries) {
+    const unsigned int max_depth = OIJSON_CHUNK_STACK_SIZE * 8;
+    for (int i = 0; i < 2; i++) {
+        summaries[i].closer_count = 0;
+        summaries[i].opener_count = 0;
+    }
+
+    const char* itr = buffer;
+    unsigned int remaining = size;
+    unsigned int parity = 0;// index of the summary outside strings
+    const char* opened[2] = { OIJSON_NULLCHAR, OIJSON_NULLCHAR };// last opening quote under each assumption
+    const char* continued_end = OIJSON_NULLCHAR;// first quote, closing the string summaries[1] starts in
+    while (remaining) {
+        while (remaining >= 8) {// '[', ']' and '\\' are folded into '{', '}' and '|'
+            unsigned long long word = oijson_internal_swar_load(itr);
+            unsigned long long folded = word | (OIJSON_SWAR_ONES * 0x20);
+            unsigned long long found = oijson_internal_swar_zero(word ^ (OIJSON_SWAR_ONES * '\"')) | oijson_internal_swar_zero(folded ^ (OIJSON_SWAR_ONES * '{')) |
+                oijson_internal_swar_zero(folded ^ (OIJSON_SWAR_ONES * '}')) | oijson_internal_swar_zero(folded ^ (OIJSON_SWAR_ONES * '|'));
+            if (found) {// step to the first one
+                while (!(found & 0x80)) {
+                    found >>= 8;
+                    itr++;
+                    remaining--;
+                }
+                break;
+            }
+            itr += 8;
+            remaining -= 8;
+        }
+        if (!remaining) {
+            break;
+        }
+
+        char c = *itr;
+        itr++;
+        remaining--;
+        oijson_chunk_summary* summary = &summaries[parity];
+        switch (c) {
+            case '\"':
+                if (!continued_end) {
+                    continued_end = itr - 1;
+                }
+                opened[parity] = itr - 1;
+                parity ^= 1;
+                break;
+            case '\\':
+                if (remaining) {
+                    itr++;
+                    remaining--;
+                }
+                break;
+            case '{':
+            case '[':
+                if (summary->opener_count < max_depth) {// deeper chunks fail when stitched
+                    oijson_internal_bit_set(summary->openers, summary->opener_count, c == '{');
+                }
+                summary->opener_count++;
+                break;
+            case '}':
+            case ']':
+                if (summary->opener_count) {
+                    summary->opener_count--;
+                    break;
+                }
+                if (summary->closer_count < max_depth) {
+                    oijson_internal_bit_set(summary->closers, summary->closer_count, c == '}');
+                }
+                summary->closer_count++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (unsigned int i = 0; i < 2; i++) {
+        oijson_chunk_summary* summary = &summaries[i];
+        const char* continued = i ? continued_end : OIJSON_NULLCHAR;
+        summary->ends_in_string = (unsigned char)(parity ^ i);
+        oijson_internal_chunk_token last;
+        if (summary->ends_in_string) {
+            last = opened[i] ? oijson_internal_chunk_token_string : oijson_internal_chunk_token_string_continued;
+        }
+        else {
+            last = oijson_internal_chunk_token_before(buffer, buffer + size, continued);
+        }
+        summary->last_token = (unsigned char)last;
+        summary->before_last_token = (unsigned char)(last == oijson_internal_chunk_token_string && opened[i] ? oijson_internal_chunk_token_before(buffer, opened[i], continued) : oijson_internal_chunk_token_none);
+    }
+}
+
+// Grammar state after a chunk, found from its last two tokens. Only strings depend on what came before them.
+static oijson_internal_chunk_state oijson_internal_chunk_end_state(oijson_internal_chunk_state start, const oijson_chunk_summary* summary, int in_object, unsigned int depth) {
+    int is_name;
+    switch (summary->last_token) {
+        case oijson_internal_chunk_token_none:
+            return start;
+        case oijson_internal_chunk_token_object:
+            return oijson_internal_chunk_state_name_or_close;
+        case oijson_internal_chunk_token_array:
+            return oijson_internal_chunk_state_value_or_close;
+        case oijson_internal_chunk_token_value_end:
+            return oijson_internal_chunk_after_value(depth);
+        case oijson_internal_chunk_token_colon:
+            return oijson_internal_chunk_state_value;
+        case oijson_internal_chunk_token_comma:
+            return in_object ? oijson_internal_chunk_state_name : oijson_internal_chunk_state_value;
+        case oijson_internal_chunk_token_string_continued:
+            is_name = start == oijson_internal_chunk_state_in_name;
+            break;
+        default:
+            switch (summary->before_last_token) {
+                case oijson_internal_chunk_token_none:
+                    is_name = start == oijson_internal_chunk_state_name || start == oijson_internal_chunk_state_name_or_close;
+                    break;
+                case oijson_internal_chunk_token_object:
+                    is_name = 1;
+                    break;
+                case oijson_internal_chunk_token_comma:
+                    is_name = in_object;
+                    break;
+                default:// a value, or invalid
+                    is_name = 0;
+                    break;
+            }
+            break;
+    }
+    if (summary->ends_in_string) {
+        return is_name ? oijson_internal_chunk_state_in_name : oijson_internal_chunk_state_in_value;
+    }
+    return is_name ? oijson_internal_chunk_state_colon : oijson_internal_chunk_after_value(depth);
+}
+
+// Nesting limit of the chunk functions, which is OIJSON_MAX_DEPTH unless it is beyond the fixed chunk stack
+#define OIJSON_INTERNAL_CHUNK_DEPTH (OIJSON_MAX_DEPTH < OIJSON_CHUNK_STACK_SIZE * 8 ? OIJSON_MAX_DEPTH : OIJSON_CHUNK_STACK_SIZE * 8)
+
+// Validates a chunk from its stitched state, with the same checks and errors as oijson_internal_consume_value.
+static oijson_internal_chunk_status oijson_internal_chunk_run(const oijson_chunk* chunk, const char** value_end) {
+    unsigned char stack[OIJSON_CHUNK_STACK_SIZE];
+    const unsigned int max_depth = OIJSON_INTERNAL_CHUNK_DEPTH;
+    unsigned int depth = chunk->depth;
+    for (unsigned int i = 0; i < (depth + 7) / 8; i++) {
+        stack[i] = chunk->stack[i];
+    }
+    oijson_internal_chunk_state state = (oijson_internal_chunk_state)chunk->state;
+    const char* itr = chunk->buffer;
+    unsigned int size = chunk->size;
+
+    while (size) {
+        if (state == oijson_internal_chunk_state_in_name || state == oijson_internal_chunk_state_in_value) {
+            itr = oijson_internal_find_string_plain_end(itr, &size);
+            if (!size) {// the string goes on in the next chunk
+                break;
+            }
+            if (*itr != '\"') {
+                itr = oijson_internal_parse_char(itr, &size, 0, 0);
+                if (!itr) {
+                    return oijson_internal_chunk_status_invalid;
+                }
+                continue;
+            }
+            itr++;
+            size--;
+            if (state == oijson_internal_chunk_state_in_name) {
+                state = oijson_internal_chunk_state_colon;
+                continue;
+            }
+        }
+        else {
+            if (oijson_internal_is_whitespace(*itr)) {
+                itr = oijson_internal_consume_whitespace(itr, &size);
+                if (!itr) {
+                    break;
+                }
+            }
+            char c = *itr;
+            int closes = depth && c == (oijson_internal_bit_get(stack, depth - 1) ? '}' : ']');
+            if (state == oijson_internal_chunk_state_end) {
+                if (c) {
+                    oijson_internal_error_set("unexpected character after value");
+                    return oijson_internal_chunk_status_invalid;
+                }
+                return oijson_internal_chunk_status_terminated;
+            }
+            else if (state == oijson_internal_chunk_state_colon) {
+                if (c != ':') {
+                    oijson_internal_error_set("':' expected");
+                    return oijson_internal_chunk_status_invalid;
+                }
+                itr++;
+                size--;
+                state = oijson_internal_chunk_state_value;
+                continue;
+            }
+            else if (closes && (state == oijson_internal_chunk_state_comma_or_close || state == oijson_internal_chunk_state_name_or_close || state == oijson_internal_chunk_state_value_or_close)) {
+                itr++;
+                size--;
+                depth--;
+            }
+            else if (state == oijson_internal_chunk_state_comma_or_close) {
+                int is_object = oijson_internal_bit_get(stack, depth - 1);
+                if (c != ',') {
+                    oijson_internal_error_set(is_object ? "',' or '}' expected" : "',' or ']' expected");
+                    return oijson_internal_chunk_status_invalid;
+                }
+                itr++;
+                size--;
+                state = is_object ? oijson_internal_chunk_state_name : oijson_internal_chunk_state_value;
+                continue;
+            }
+            else if (state == oijson_internal_chunk_state_name || state == oijson_internal_chunk_state_name_or_close) {
+                if (c != '\"') {
+                    oijson_internal_error_set("name expected");
+                    return oijson_internal_chunk_status_invalid;
+                }
+                itr++;
+                size--;
+                state = oijson_internal_chunk_state_in_name;
+                continue;
+            }
+            else if (c == '{' || c == '[') {
+                if (depth == max_depth) {
+                    oijson_internal_error_set("maximum depth exceeded");
+                    return oijson_internal_chunk_status_invalid;
+                }
+                oijson_internal_bit_set(stack, depth, c == '{');
+                depth++;
+                itr++;
+                size--;
+                state = c == '{' ? oijson_internal_chunk_state_name_or_close : oijson_internal_chunk_state_value_or_close;
+                continue;
+            }
+            else if (c == '\"') {
+                itr++;
+                size--;
+                state = oijson_internal_chunk_state_in_value;
+                continue;
+            }
+            else {
+                itr = oijson_internal_consume_scalar(itr, &size);
+                if (!itr) {
+                    return oijson_internal_chunk_status_invalid;
+                }
+            }
+        }
+
+        state = oijson_internal_chunk_after_value(depth);// a value was completed
+        if (state == oijson_internal_chunk_state_end) {
+            *value_end = itr;
+        }
+    }
+    return state == oijson_internal_chunk_state_end ? oijson_internal_chunk_status_complete : oijson_internal_chunk_status_valid;
+}
+
+unsigned int oijson_chunk_split(const char* json, unsigned int json_size, oijson_chunk* chunks, unsigned int chunk_count) {
+    if (!json) {
+        oijson_internal_error_set("invalid string");
+        return 0;
+    }
+    if (!chunks || !chunk_count) {
+        oijson_internal_error_set("invalid chunks");
+        return 0;
+    }
+
+    unsigned int step = json_size / chunk_count;
+    unsigned int count = 0;
+    unsigned int start = 0;
+    do {
+        unsigned int end = json_size;
+        if (count + 1 < chunk_count && json_size) {// move each cut forward to a delimiter, not after a backslash so escapes stay whole
+            end = (count + 1) * step > start ? (count + 1) * step : start + 1;
+            while (end < json_size && (!oijson_internal_is_chunk_boundary(json[end]) || json[end - 1] == '\\')) {
+                end++;
+            }
+        }
+        oijson_chunk* chunk = &chunks[count++];
+        chunk->buffer = json + start;
+        chunk->size = end - start;
+        chunk->depth = 0;
+        chunk->state = oijson_internal_chunk_state_unknown;
+        chunk->status = oijson_internal_chunk_status_pending;
+        chunk->value_end = OIJSON_NULLCHAR;
+        start = end;
+    } while (start < json_size);
+    return count;
+}
+
+int oijson_chunk_scan(oijson_chunk* chunk) {
+    if (!chunk) {
+        oijson_internal_error_set("invalid chunks");
+        return 0;
+    }
+
+    oijson_internal_chunk_summarize(chunk->buffer, chunk->size, chunk->summaries);
+    return 1;
+}
+
+unsigned int oijson_chunk_stitch(oijson_chunk* chunks, unsigned int chunk_count) {
+    if (!chunks) {
+        oijson_internal_error_set("invalid chunks");
+        return 0;
+    }
+
+    unsigned char stack[OIJSON_CHUNK_STACK_SIZE];
+    const unsigned int max_depth = OIJSON_INTERNAL_CHUNK_DEPTH;
+    unsigned int depth = 0;
+    oijson_internal_chunk_state state = oijson_internal_chunk_state_value;
+    for (unsigned int i = 0; i < chunk_count; i++) {
+        oijson_chunk* chunk = &chunks[i];
+        chunk->state = (unsigned char)state;
+        chunk->depth = depth;
+        for (unsigned int j = 0; j < (depth + 7) / 8; j++) {
+            chunk->stack[j] = stack[j];
+        }
+
+        int in_string = state == oijson_internal_chunk_state_in_name || state == oijson_internal_chunk_state_in_value;
+        const oijson_chunk_summary* summary = &chunk->summaries[in_string];
+        int consistent = summary->closer_count <= depth && summary->opener_count <= max_depth;
+        for (unsigned int j = 0; consistent && j < summary->closer_count; j++) {
+            consistent = oijson_internal_bit_get(summary->closers, j) == oijson_internal_bit_get(stack, depth - 1);
+            depth--;
+        }
+        if (!consistent || depth + summary->opener_count > max_depth) {// this chunk fails or ends the document, the rest is not needed
+            for (unsigned int j = i + 1; j < chunk_count; j++) {
+                chunks[j].status = oijson_internal_chunk_status_skipped;
+            }
+            return i + 1;
+        }
+        for (unsigned int j = 0; j < summary->opener_count; j++) {
+            oijson_internal_bit_set(stack, depth, oijson_internal_bit_get(summary->openers, j));
+            depth++;
+        }
+        state = oijson_internal_chunk_end_state(state, summary, depth && oijson_internal_bit_get(stack, depth - 1), depth);
+    }
+    return chunk_count;
+}
+
+int oijson_chunk_validate(oijson_chunk* chunk) {
+    if (!chunk) {
+        oijson_internal_error_set("invalid chunks");
+        return 0;
+    }
+
+    chunk->status = (unsigned char)oijson_internal_chunk_run(chunk, &chunk->value_end);
+    return chunk->status != oijson_internal_chunk_status_invalid;
+}
+
+oijson oijson_chunk_result(const oijson_chunk* chunks, unsigned int chunk_count) {
+    if (!chunks || !chunk_count) {
+        oijson_internal_error_set("invalid chunks");
+        return OIJSON_INVALID;
+    }
+
+    const char* value_end = OIJSON_NULLCHAR;
+    oijson_internal_chunk_status status = oijson_internal_chunk_status_pending;
+    for (unsigned int i = 0; i < chunk_count; i++) {
+        status = (oijson_internal_chunk_status)chunks[i].status;
+        if (chunks[i].value_end) {
+            value_end = chunks[i].value_end;
+        }
+        if (status == oijson_internal_chunk_status_invalid) {
+            const char* unused;
+            oijson_internal_chunk_run(&chunks[i], &unused);// again on this thread, for the error
+            return OIJSON_INVALID;
+        }
+        if (status == oijson_internal_chunk_status_terminated || status == oijson_internal_chunk_status_pending || status == oijson_internal_chunk_status_skipped) {
+            break;
+        }
+    }
+    if (status == oijson_internal_chunk_status_pending || status == oijson_internal_chunk_status_skipped) {
+        oijson_internal_error_set("chunk not validated");
+        return OIJSON_INVALID;
+    }
+
+    const oijson_chunk* last = &chunks[chunk_count - 1];
+    unsigned int size = (unsigned int)(last->buffer + last->size - chunks[0].buffer);
+    const char* start = oijson_internal_consume_whitespace(chunks[0].buffer, &size);
+    if (!start) {
+        oijson_internal_error_set("invalid string");
+        return OIJSON_INVALID;
+    }
+    if (!value_end || (status != oijson_internal_chunk_status_complete && status != oijson_internal_chunk_status_terminated)) {
+        oijson_internal_error_set("unexpected end of json string");
+        return OIJSON_INVALID;
+    }
+    oijson out_json = {
+        .buffer = start,
+        .size = (unsigned int)(value_end - start),
+        .type = oijson_internal_type_from_char(*start),
+    };
+    return out_json;
+}
+
+oijson oijson_parse_chunked(const char* json, unsigned int json_size, oijson_chunk* chunks, unsigned int chunk_count) {
+    unsigned int count = oijson_chunk_split(json, json_size, chunks, chunk_count);
+    for (unsigned int i = 0; i < count; i++) {
+        oijson_chunk_scan(&chunks[i]);
+    }
+    unsigned int validated = oijson_chunk_stitch(chunks, count);
+    for (unsigned int i = 0; i < validated; i++) {
+        oijson_chunk_validate(&chunks[i]);
+    }
+    return count ? oijson_chunk_result(chunks, count) : OIJSON_INVALID;
+}
+
+oijson oijson_parse_lazy(const char* string, unsigned int string_size) {
+    string = oijson_internal_consume_whitespace(string, &string_size);
+    if (!string) {
+        oijson_internal_error_set("invalid string");
+        return OIJSON_INVALID;
+    }
+
+    oijson out_json = OIJSON_INVALID;
+    if (*string == '{' || *string == '[') {// the extent is left open, elements are found as they are read
+        out_json.buffer = string;
+        out_json.size = string_size;
+        out_json.type = *string == '{' ? oijson_type_object : oijson_type_array;
+        return out_json;
+    }
+    const char* itr = oijson_internal_skip_value(string, &string_size, &out_json);
+    if (!itr) {
+        return OIJSON_INVALID;
+    }
+    itr = oijson_internal_consume_whitespace(itr, &string_size);// a scalar has a closed extent, so what follows is checked here
+    if (string_size && *itr) {
+        oijson_internal_error_set("unexpected character after value");
+        return OIJSON_INVALID;
+    }
+    return out_json;
+}
+
+int oijson_validate(oijson value) {
+    if (value.type == oijson_type_invalid) {
+        oijson_internal_error_set("invalid value");
+        return 0;
+    }
+    oijson parsed = oijson_parse(value.buffer, value.size);
+    return parsed.type == value.type;
+}
+
+int oijson_minify(const char* json, unsigned int json_size, char* out, unsigned int out_size) {
+    if (!json || !out) {
+        oijson_internal_error_set("invalid string");
+        return 0;
+    }
+    if (!out_size) {// reserve the null terminator without touching out, which may alias json
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+    out_size--;
+
+    int in_string = 0;
+    while (json_size) {
+        if (json_size >= 8 && out_size >= 8) {// copy whole words while nothing needs attention
+            unsigned long long word = oijson_internal_swar_load(json);
+            unsigned long long special = in_string
+                ? oijson_internal_swar_equal(word, '\"') | oijson_internal_swar_equal(word, '\\') | oijson_internal_swar_less(word, 1)
+                : oijson_internal_swar_equal(word, '\"') | oijson_internal_swar_less(word, 0x21);// whitespace, control characters and '\0'
+            if (!special) {
+                oijson_internal_swar_store(out, word);
+                json += 8;
+                json_size -= 8;
+                out += 8;
+                out_size -= 8;
+                continue;
+            }
+        }
+
+        char c = *json;
+        if (!c) {
+            break;
+        }
+        json++;
+        json_size--;
+        if (in_string) {
+            if (c == '\\' && json_size) {// copy escaped character as is
+                if (!oijson_internal_push_char(&out, &out_size, c)) {
+                    *out = '\0';
+                    return 0;
+                }
+                c = *json;
+                json++;
+                json_size--;
+            }
+            else if (c == '\"') {
+                in_string = 0;
+            }
+        }
+        else if (oijson_internal_is_whitespace(c)) {
+            continue;
+        }
+        else if (c == '\"') {
+            in_string = 1;
+        }
+        if (!oijson_internal_push_char(&out, &out_size, c)) {
+            *out = '\0';
+            return 0;
+        }
+    }
+    *out = '\0';
+    return 1;
+}
+
+static unsigned long long oijson_internal_checksum(const char* data, unsigned int size) {// hashes 8 bytes at a time, not meant to be cryptographic
+    unsigned long long hash = 0x9E3779B97F4A7C15ULL ^ size;
+    while (size >= 8) {
+        hash = ((hash << 5 | hash >> 59) ^ oijson_internal_swar_load(data)) * 0x100000001B3ULL;
+        data += 8;
+        size -= 8;
+    }
+    unsigned long long tail = 0;
+    for (unsigned int i = 0; i < size; i++) {
+        tail |= (unsigned long long)(unsigned char)data[i] << (i * 8);
+    }
+    hash = ((hash << 5 | hash >> 59) ^ tail) * 0x100000001B3ULL;
+    return hash ^ hash >> 32;
+}
+
+static void oijson_internal_index_store(unsigned char* out, unsigned long long value, unsigned int byte_count) {// little endian
+    for (unsigned int i = 0; i < byte_count; i++) {
+        out[i] = (unsigned char)(value >> (i * 8));
+    }
+}
+
+static unsigned long long oijson_internal_index_load(const unsigned char* index, unsigned int byte_count) {
+    unsigned long long value = 0;
+    for (unsigned int i = byte_count; i > 0; i--) {
+        value = value << 8 | index[i - 1];
+    }
+    return value;
+}
+
+// Index layout, little endian: magic "OIJX", version, source size, value offset, value size, value type, checksum(8 bytes)
+#define OIJSON_INDEX_VERSION 1
+
+int oijson_index_save(const char* json, unsigned int json_size, oijson value, unsigned char* out, unsigned int out_size) {
+    if (!json || !out || value.type == oijson_type_invalid) {
+        oijson_internal_error_set("invalid value");
+        return 0;
+    }
+    if (value.buffer < json || value.size > json_size || (unsigned int)(value.buffer - json) > json_size - value.size) {
+        oijson_internal_error_set("value is not part of json");
+        return 0;
+    }
+    if (out_size < OIJSON_INDEX_SIZE) {
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+
+    out[0] = 'O';
+    out[1] = 'I';
+    out[2] = 'J';
+    out[3] = 'X';
+    oijson_internal_index_store(out + 4, OIJSON_INDEX_VERSION, 4);
+    oijson_internal_index_store(out + 8, json_size, 4);
+    oijson_internal_index_store(out + 12, (unsigned long long)(value.buffer - json), 4);
+    oijson_internal_index_store(out + 16, value.size, 4);
+    oijson_internal_index_store(out + 20, (unsigned long long)value.type, 4);
+    oijson_internal_index_store(out + 24, oijson_internal_checksum(json, json_size), 8);
+    return 1;
+}
+
+oijson oijson_index_load(const unsigned char* index, unsigned int index_size, const char* json, unsigned int json_size, int verify_checksum) {
+    if (!index || !json || index_size < OIJSON_INDEX_SIZE || index[0] != 'O' || index[1] != 'I' || index[2] != 'J' || index[3] != 'X') {
+        oijson_internal_error_set("invalid index");
+        return OIJSON_INVALID;
+    }
+    if (oijson_internal_index_load(index + 4, 4) != OIJSON_INDEX_VERSION) {
+        oijson_internal_error_set("unsupported index version");
+        return OIJSON_INVALID;
+    }
+
+    unsigned long long offset = oijson_internal_index_load(index + 12, 4);
+    unsigned long long size = oijson_internal_index_load(index + 16, 4);
+    unsigned long long type = oijson_internal_index_load(index + 20, 4);
+    if (oijson_internal_index_load(index + 8, 4) != json_size || offset + size > json_size || type == oijson_type_invalid || type > oijson_type_null) {
+        oijson_internal_error_set("index does not match json");
+        return OIJSON_INVALID;
+    }
+    if (verify_checksum && oijson_internal_index_load(index + 24, 8) != oijson_internal_checksum(json, json_size)) {
+        oijson_internal_error_set("checksum mismatch");
         return OIJSON_INVALID;
     }
 
-    oijson_iterator iterator = oijson_iterator_create(object);
-    while (iterator.type != oijson_iterator_type_invalid) {
-        if (oijson_internal_check_value(iterator.name.buffer, iterator.name.size, name)) {
-            return iterator.value;
-        }
-        oijson_iterator_advance(&iterator);
+    oijson out_json = {
+        .buffer = json + offset,
+        .size = (unsigned int)size,
+        .type = (oijson_type)type,
+    };
+    return out_json;
+}
+
+// A DOM index is the index of its root followed by the node count and every node: type, offset, then the double of a
+// number, the size of a string, or the first child and count of a container, all little endian.
+int oijson_index_save_dom(const oijson_dom* dom, unsigned char* out, unsigned int out_size, unsigned int* out_written) {
+    if (!dom || !dom->count) {
+        oijson_internal_error_set("empty dom");
+        return 0;
+    }
+    unsigned long long size = OIJSON_INDEX_SIZE + 4 + (unsigned long long)dom->count * OIJSON_INDEX_NODE_SIZE;
+    if (size > out_size) {
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+    if (!oijson_index_save(dom->buffer, dom->buffer_size, oijson_dom_value(dom, dom->nodes), out, out_size)) {
+        return 0;
+    }
+
+    oijson_internal_index_store(out + OIJSON_INDEX_SIZE, dom->count, 4);
+    unsigned char* itr = out + OIJSON_INDEX_SIZE + 4;
+    for (unsigned int i = 0; i < dom->count; i++, itr += OIJSON_INDEX_NODE_SIZE) {
+        const oijson_node* node = &dom->nodes[i];
+        unsigned long long data = 0;
+        switch (node->type) {
+            case oijson_type_object:
+            case oijson_type_array:
+                data = node->data.children.first | (unsigned long long)node->data.children.count << 32;
+                break;
+            case oijson_type_string:
+                data = node->data.size;
+                break;
+            case oijson_type_number:
+            {
+                union { double d; unsigned long long u; } bits;
+                bits.d = node->data.real;
+                data = bits.u;
+                break;
+            }
+            default:
+                break;
+        }
+        oijson_internal_index_store(itr, (unsigned long long)node->type, 4);
+        oijson_internal_index_store(itr + 4, node->offset, 4);
+        oijson_internal_index_store(itr + 8, data, 8);
+    }
+    if (out_written) {
+        *out_written = (unsigned int)size;
+    }
+    return 1;
+}
+
+// Nodes are checked to start inside json and children to come after their parent, as oijson_dom_build stores them,
+// so a damaged index cannot send navigation past the nodes or around in a loop.
+int oijson_index_load_dom(const unsigned char* index, unsigned int index_size, const char* json, unsigned int json_size, int verify_checksum, oijson_dom* dom) {
+    if (!dom) {
+        oijson_internal_error_set("invalid dom");
+        return 0;
+    }
+    dom->count = 0;// previous nodes are discarded
+    dom->buffer = OIJSON_NULLCHAR;
+    dom->buffer_size = 0;
+
+    oijson root = oijson_index_load(index, index_size, json, json_size, verify_checksum);
+    if (root.type == oijson_type_invalid) {
+        return 0;
+    }
+    unsigned long long count = index_size >= OIJSON_INDEX_SIZE + 4 ? oijson_internal_index_load(index + OIJSON_INDEX_SIZE, 4) : 0;
+    if (!count || index_size - OIJSON_INDEX_SIZE - 4 < count * OIJSON_INDEX_NODE_SIZE) {
+        oijson_internal_error_set("invalid index");
+        return 0;
+    }
+    if (count > dom->capacity) {
+        oijson_internal_error_set("not enough nodes");
+        return 0;
+    }
+
+    const unsigned char* itr = index + OIJSON_INDEX_SIZE + 4;
+    for (unsigned int i = 0; i < count; i++, itr += OIJSON_INDEX_NODE_SIZE) {
+        oijson_node* node = &dom->nodes[i];
+        unsigned long long type = oijson_internal_index_load(itr, 4);
+        unsigned long long offset = oijson_internal_index_load(itr + 4, 4);
+        unsigned long long data = oijson_internal_index_load(itr + 8, 8);
+        int valid = type != oijson_type_invalid && type <= oijson_type_null && offset < json_size;
+        node->type = (oijson_type)type;
+        node->offset = (unsigned int)offset;
+        switch (node->type) {
+            case oijson_type_object:
+            case oijson_type_array:
+                node->data.children.first = (unsigned int)data;
+                node->data.children.count = (unsigned int)(data >> 32);
+                valid = valid && (unsigned int)data > i &&
+                    (unsigned long long)(unsigned int)data + (data >> 32) * (node->type == oijson_type_object ? 2 : 1) <= count;
+                break;
+            case oijson_type_string:
+                node->data.size = (unsigned int)data;
+                valid = valid && data >= 2 && data <= json_size - offset;
+                break;
+            case oijson_type_number:
+            {
+                union { double d; unsigned long long u; } bits;
+                bits.u = data;
+                node->data.real = bits.d;
+                break;
+            }
+            default:
+                break;
+        }
+        if (!valid || (i == 0 && (node->type != root.type || json + offset != root.buffer))) {
+            oijson_internal_error_set("index does not match json");
+            return 0;
+        }
+    }
+    dom->count = (unsigned int)count;
+    dom->buffer = json;
+    dom->buffer_size = json_size;
+    return 1;
+}
+
+oijson_cache oijson_cache_create(oijson_cache_entry* entries, unsigned int entry_count, char* bytes, unsigned int byte_count, oijson_lock_function lock, oijson_lock_function unlock, void* user_data) {
+    oijson_cache cache = {
+        .entries = entries,
+        .set_count = entries && bytes ? entry_count / OIJSON_CACHE_WAYS : 0,
+        .bytes = bytes,
+        .slot_size = 0,
+        .lock = lock,
+        .unlock = unlock,
+        .user_data = user_data,
+    };
+    if (cache.set_count) {
+        cache.slot_size = byte_count / (cache.set_count * OIJSON_CACHE_WAYS);
+    }
+    if (!cache.slot_size) {
+        cache.set_count = 0;
+        oijson_internal_error_set("not enough entries, caching disabled");
+    }
+    for (unsigned int i = 0; i < cache.set_count * OIJSON_CACHE_WAYS; i++) {
+        entries[i].json_size = 0;
+        entries[i].stamp = 0;
+    }
+    return cache;
+}
+
+static void oijson_internal_cache_touch(oijson_cache_entry* set, oijson_cache_entry* entry) {// makes entry the most recently used of its set
+    unsigned int newest = 0;
+    for (unsigned int i = 0; i < OIJSON_CACHE_WAYS; i++) {
+        if (set[i].stamp > newest) {
+            newest = set[i].stamp;
+        }
+    }
+    if (newest == 0xFFFFFFFFu) {// renumber the set before the stamps wrap around, keeping their order and 0 for unused entries
+        unsigned int ranks[OIJSON_CACHE_WAYS];
+        newest = 0;
+        for (unsigned int i = 0; i < OIJSON_CACHE_WAYS; i++) {
+            ranks[i] = 0;
+            for (unsigned int j = 0; set[i].stamp && j < OIJSON_CACHE_WAYS; j++) {
+                ranks[i] += set[j].stamp && set[j].stamp <= set[i].stamp;
+            }
+            if (ranks[i] > newest) {
+                newest = ranks[i];
+            }
+        }
+        for (unsigned int i = 0; i < OIJSON_CACHE_WAYS; i++) {
+            set[i].stamp = ranks[i];
+        }
+    }
+    entry->stamp = newest + 1;
+}
+
+static oijson_cache_entry* oijson_internal_cache_find(const oijson_cache* cache, oijson_cache_entry* set, unsigned long long hash, const char* json, unsigned int json_size) {
+    for (unsigned int i = 0; i < OIJSON_CACHE_WAYS; i++) {
+        if (set[i].json_size != json_size || set[i].hash != hash) {
+            continue;
+        }
+        const char* copy = cache->bytes + (unsigned long long)(set + i - cache->entries) * cache->slot_size;
+        unsigned int j = 0;
+        while (j < json_size && copy[j] == json[j]) {// a matching hash is not proof, the bytes are
+            j++;
+        }
+        if (j == json_size) {
+            return &set[i];
+        }
+    }
+    return 0;
+}
+
+static oijson oijson_internal_cache_lookup(const oijson_cache* cache, oijson_cache_entry* set, unsigned long long hash, const char* json, unsigned int json_size) {
+    oijson_cache_entry* found = oijson_internal_cache_find(cache, set, hash, json, json_size);
+    if (!found) {
+        return OIJSON_INVALID;
+    }
+
+    oijson_internal_cache_touch(set, found);
+    oijson out_json = {
+        .buffer = json + found->offset,
+        .size = found->size,
+        .type = found->type,
+    };
+    return out_json;
+}
+
+static void oijson_internal_cache_insert(const oijson_cache* cache, oijson_cache_entry* set, unsigned long long hash, const char* json, unsigned int json_size, oijson value) {
+    if (oijson_internal_cache_find(cache, set, hash, json, json_size)) {// inserted by another thread meanwhile
+        return;
+    }
+    oijson_cache_entry* oldest = set;
+    for (unsigned int i = 1; i < OIJSON_CACHE_WAYS; i++) {
+        if (set[i].stamp < oldest->stamp) {// unused entries have the lowest stamp
+            oldest = &set[i];
+        }
+    }
+
+    char* copy = cache->bytes + (unsigned long long)(oldest - cache->entries) * cache->slot_size;
+    for (unsigned int i = 0; i < json_size; i++) {
+        copy[i] = json[i];
+    }
+    oldest->hash = hash;
+    oldest->json_size = json_size;
+    oldest->offset = (unsigned int)(value.buffer - json);
+    oldest->size = value.size;
+    oldest->type = value.type;
+    oijson_internal_cache_touch(set, oldest);
+}
+
+oijson oijson_cache_parse(oijson_cache* cache, const char* json, unsigned int json_size) {
+    if (!cache || !cache->set_count || !json || !json_size || json_size > cache->slot_size) {
+        return oijson_parse(json, json_size);
+    }
+
+    unsigned long long hash = oijson_internal_checksum(json, json_size);
+    unsigned int set_index = (unsigned int)(hash % cache->set_count);
+    oijson_cache_entry* set = cache->entries + set_index * OIJSON_CACHE_WAYS;
+
+    if (cache->lock) {
+        cache->lock(cache->user_data, set_index);
+    }
+    oijson out_json = oijson_internal_cache_lookup(cache, set, hash, json, json_size);
+    if (cache->unlock) {
+        cache->unlock(cache->user_data, set_index);
+    }
+    if (out_json.type != oijson_type_invalid) {
+        return out_json;
+    }
+
+    out_json = oijson_parse(json, json_size);// parsed without holding the lock
+    if (out_json.type == oijson_type_invalid) {// errors are not cached, so oijson_error stays meaningful
+        return out_json;
+    }
+    if (cache->lock) {
+        cache->lock(cache->user_data, set_index);
+    }
+    oijson_internal_cache_insert(cache, set, hash, json, json_size, out_json);
+    if (cache->unlock) {
+        cache->unlock(cache->user_data, set_index);
+    }
+    return out_json;
+}
+
+unsigned int oijson_object_count(oijson object) {
+    if (object.type != oijson_type_object) {
+        oijson_internal_error_set("not an object");
+        return 0;
+    }
+
+    unsigned int count = 0;
+    oijson_iterator iterator;
+    int valid = oijson_internal_iterator_start(object, &iterator);
+    while (valid && iterator.type != oijson_iterator_type_invalid) {
+        count++;
+        valid = oijson_internal_iterator_next(&iterator);
+    }
+    return valid ? count : 0;
+}
+
+static int oijson_internal_check_value(const char* ptr, unsigned int len, const char* name) {
+    ptr++;
+
+    const char* key = ptr;
+    unsigned int key_size = len - 2;
+
+    unsigned int name_size = 0;
+    {
+        const char* itr = name;
+        while (*itr) {
+            itr++;
+            name_size++;
+        }
+    }
+
+    while (key_size && name_size) {
+        char parsed_key[5] = { 0, 0, 0, 0, 0 };
+        char* parsed_key_ptr = parsed_key;
+        unsigned int parsed_key_size = 5;
+        char parsed_name[5] = { 0, 0, 0, 0, 0 };
+        char* parsed_name_ptr = parsed_name;
+        unsigned int parsed_name_size = 5;
+
+        key = oijson_internal_parse_char(key, &key_size, &parsed_key_ptr, &parsed_key_size);
+        name = oijson_internal_parse_char(name, &name_size, &parsed_name_ptr, &parsed_name_size);
+
+        if (!key && !name) {
+            return 1;
+        }
+        if (parsed_key_size != parsed_name_size) {
+            return 0;
+        }
+        for(int i = 0; i < 5; i++) {
+            if (!parsed_key[i] || !parsed_name[i]) {
+                break;
+            }
+            if (parsed_key[i] != parsed_name[i]) {
+                return 0;
+            }
+        }
+    }
+    return !key_size && !name_size;
+}
+
+static int oijson_internal_name_equals(oijson name, const char* string) {// compares bytes directly, decoding only when escape sequences are found
+    const char* key = name.buffer + 1;
+    unsigned int key_size = name.size - 2;
+    for (unsigned int i = 0; i < key_size; i++) {
+        if (key[i] == '\\' || string[i] == '\\') {
+            return oijson_internal_check_value(name.buffer, name.size, string);
+        }
+        if (key[i] != string[i]) {
+            return 0;
+        }
+    }
+    return !string[key_size];
+}
+
+int oijson_find_all_by_key(oijson value, const char* name, oijson* out, unsigned int out_size, unsigned int* out_count) {
+    if (value.type == oijson_type_invalid || !name || (!out && out_size)) {
+        oijson_internal_error_set("invalid value");
+        return 0;
+    }
+
+    const char* itr = value.buffer;
+    unsigned int size = value.size;
+    unsigned int depth = 0;
+    unsigned int count = 0;
+    while (size && (value.type == oijson_type_object || value.type == oijson_type_array)) {
+        while (size >= 8) {// same scan as skip_container, only quotes and brackets matter outside strings
+            unsigned long long word = oijson_internal_swar_load(itr);
+            unsigned long long folded = word | (OIJSON_SWAR_ONES * 0x20);
+            if (oijson_internal_swar_equal(word, '\"') | oijson_internal_swar_equal(folded, '{') | oijson_internal_swar_equal(folded, '}')) {
+                break;
+            }
+            itr += 8;
+            size -= 8;
+        }
+        if (!size) {
+            break;
+        }
+
+        char c = *itr;
+        if (c == '\"') {
+            oijson key = {
+                .buffer = itr,
+                .size = size,
+                .type = oijson_type_string,
+            };
+            itr = oijson_internal_skip_string(itr, &size);
+            if (!itr) {
+                return 0;
+            }
+            key.size -= size;
+
+            const char* colon = itr;
+            unsigned int colon_size = size;
+            while (colon_size && oijson_internal_is_whitespace(*colon)) {
+                colon++;
+                colon_size--;
+            }
+            if (!colon_size || *colon != ':' || !oijson_internal_name_equals(key, name)) {// strings not followed by ':' are values
+                continue;
+            }
+            itr = colon + 1;// the value is scanned too, for keys nested in it
+            size = colon_size - 1;
+            colon_size = size;
+            oijson found;
+            if (!oijson_internal_skip_value(itr, &colon_size, &found)) {
+                return 0;
+            }
+            if (count < out_size) {
+                out[count] = found;
+            }
+            count++;
+            continue;
+        }
+        itr++;
+        size--;
+        if (c == '{' || c == '[') {
+            depth++;
+        }
+        else if ((c == '}' || c == ']') && !--depth) {// lazy roots may extend past their value
+            break;
+        }
+    }
+
+    if (out_count) {
+        *out_count = count;
+    }
+    if (count > out_size) {
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+    return 1;
+}
+
+static unsigned long long oijson_internal_fnv1a(unsigned long long hash, const char* data, unsigned int size) {
+    for (unsigned int i = 0; i < size; i++) {
+        hash = (hash ^ (unsigned char)data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define OIJSON_FNV1A_BASIS 0xcbf29ce484222325ULL
+
+static int oijson_internal_string_hash(oijson string, unsigned long long* out) {// hashes the decoded string, so escaped spellings match
+    const char* itr = string.buffer + 1;
+    unsigned int size = string.size - 2;
+    unsigned long long hash = OIJSON_FNV1A_BASIS;
+    while (size) {
+        if (*itr != '\\') {
+            hash = oijson_internal_fnv1a(hash, itr, 1);
+            itr++;
+            size--;
+            continue;
+        }
+        char decoded[4];
+        char* decoded_itr = decoded;
+        unsigned int decoded_size = sizeof(decoded);
+        itr = oijson_internal_parse_char(itr, &size, &decoded_itr, &decoded_size);
+        if (!itr) {
+            return 0;
+        }
+        hash = oijson_internal_fnv1a(hash, decoded, (unsigned int)(decoded_itr - decoded));
+    }
+    *out = hash;
+    return 1;
+}
+
+oijson_keyset oijson_keyset_create(const char* const* names, unsigned int name_count, oijson_keyset_slot* slots, unsigned int slot_count) {
+    oijson_keyset keyset = {
+        .names = names,
+        .slots = slots,
+        .slot_count = 0,
+    };
+    unsigned int count = 1;// largest power of two that fits, so slots are found with a mask
+    while (count <= slot_count / 2) {
+        count *= 2;
+    }
+    if (!names || !slots || !slot_count || count <= name_count) {// one slot stays empty to end every probe
+        oijson_internal_error_set("not enough slots");
+        return keyset;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        slots[i].id = -1;
+    }
+
+    for (unsigned int id = 0; id < name_count; id++) {
+        if (!names[id]) {
+            oijson_internal_error_set("invalid name");
+            return keyset;
+        }
+        unsigned int size = 0;
+        while (names[id][size]) {
+            size++;
+        }
+        unsigned int hash = (unsigned int)oijson_internal_fnv1a(OIJSON_FNV1A_BASIS, names[id], size);
+        unsigned int slot = hash & (count - 1);
+        while (slots[slot].id >= 0) {
+            const char* other = names[slots[slot].id];
+            unsigned int i = 0;
+            while (i < size && other[i] == names[id][i]) {
+                i++;
+            }
+            if (slots[slot].hash == hash && i == size && !other[i]) {
+                oijson_internal_error_set_field("duplicate name", names[id]);
+                return keyset;
+            }
+            slot = (slot + 1) & (count - 1);
+        }
+        slots[slot].hash = hash;
+        slots[slot].id = (int)id;
+    }
+    keyset.slot_count = count;
+    return keyset;
+}
+
+int oijson_keyset_find(const oijson_keyset* keyset, oijson name) {
+    unsigned long long name_hash;
+    if (!keyset || !keyset->slot_count || name.type != oijson_type_string || !oijson_internal_string_hash(name, &name_hash)) {
+        return -1;
+    }
+    unsigned int hash = (unsigned int)name_hash;
+    unsigned int mask = keyset->slot_count - 1;
+    for (unsigned int slot = hash & mask; keyset->slots[slot].id >= 0; slot = (slot + 1) & mask) {
+        if (keyset->slots[slot].hash == hash && oijson_internal_name_equals(name, keyset->names[keyset->slots[slot].id])) {
+            return keyset->slots[slot].id;
+        }
+    }
+    return -1;
+}
+
+oijson oijson_object_value_by_name(oijson object, const char* name) {
+    if (object.type != oijson_type_object || !name) {
+        oijson_internal_error_set("not an object");
+        return OIJSON_INVALID;
+    }
+
+    oijson_iterator iterator;
+    int valid = oijson_internal_iterator_start(object, &iterator);
+    while (valid && iterator.type != oijson_iterator_type_invalid) {
+        if (oijson_internal_name_equals(iterator.name, name)) {
+            return iterator.value;
+        }
+        valid = oijson_internal_iterator_next(&iterator);
+    }
+    if (valid) {
+        oijson_internal_error_set("name/value pair not found");
+    }
+    return OIJSON_INVALID;
+}
+
+oijson oijson_object_value_by_index(oijson object, unsigned int index) {
+    if (object.type != oijson_type_object) {
+        oijson_internal_error_set("not an object");
+        return OIJSON_INVALID;
+    }
+
+    oijson_iterator iterator;
+    int valid = oijson_internal_iterator_start(object, &iterator);
+    while (valid && iterator.type != oijson_iterator_type_invalid && index--) {
+        valid = oijson_internal_iterator_next(&iterator);
+    }
+    if (valid && iterator.type == oijson_iterator_type_invalid) {
+        oijson_internal_error_set("index out of range");
+    }
+    return iterator.value;
+}
+
+oijson oijson_object_name_by_index(oijson object, unsigned int index) {
+    if (object.type != oijson_type_object) {
+        oijson_internal_error_set("not an object");
+        return OIJSON_INVALID;
+    }
+
+    oijson_iterator iterator;
+    int valid = oijson_internal_iterator_start(object, &iterator);
+    while (valid && iterator.type != oijson_iterator_type_invalid && index--) {
+        valid = oijson_internal_iterator_next(&iterator);
+    }
+    if (valid && iterator.type == oijson_iterator_type_invalid) {
+        oijson_internal_error_set("index out of range");
+    }
+    return iterator.name;
+}
+
+
+unsigned int oijson_array_count(oijson array) {
+    if (array.type != oijson_type_array) {
+        oijson_internal_error_set("not an array");
+        return 0;
+    }
+
+    unsigned int count = 0;
+    oijson_iterator iterator;
+    int valid = oijson_internal_iterator_start(array, &iterator);
+    while (valid && iterator.type != oijson_iterator_type_invalid) {
+        count++;
+        valid = oijson_internal_iterator_next(&iterator);
+    }
+    return valid ? count : 0;
+}
+
+oijson oijson_array_value_by_index(oijson array, unsigned int index) {
+    if (array.type != oijson_type_array) {
+        oijson_internal_error_set("not an array");
+        return OIJSON_INVALID;
+    }
+
+    oijson_iterator iterator;
+    int valid = oijson_internal_iterator_start(array, &iterator);
+    while (valid && iterator.type != oijson_iterator_type_invalid && index--) {
+        valid = oijson_internal_iterator_next(&iterator);
+    }
+    if (valid && iterator.type == oijson_iterator_type_invalid) {
+        oijson_internal_error_set("index out of range");
+    }
+    return iterator.value;
+}
+
+static int oijson_internal_formatted_value(oijson value, char** out_ptr, unsigned int* out_size_ptr);
+
+static int oijson_internal_formatted_object(oijson object, char** out_ptr, unsigned int* out_size_ptr) {
+    if (!oijson_internal_push_char(out_ptr, out_size_ptr, '{')) {
+        return 0;
+    }
+
+    oijson_iterator iterator = oijson_iterator_create(object);
+    while (iterator.type != oijson_iterator_type_invalid) {
+        if (!oijson_internal_formatted_value(iterator.name, out_ptr, out_size_ptr)) {
+            return 0;
+        }
+
+        if (!oijson_internal_push_char(out_ptr, out_size_ptr, ':')) {
+            return 0;
+        }
+
+        if (!oijson_internal_formatted_value(iterator.value, out_ptr, out_size_ptr)) {
+            return 0;
+        }
+
+        oijson_iterator_advance(&iterator);
+        if (iterator.type != oijson_iterator_type_invalid) {
+            if (!oijson_internal_push_char(out_ptr, out_size_ptr, ',')) {
+                return 0;
+            }
+        }
+    }
+
+    return oijson_internal_push_char(out_ptr, out_size_ptr, '}');
+}
+
+static int oijson_internal_formatted_array(oijson array, char** out_ptr, unsigned int* out_size_ptr) {
+    if (!oijson_internal_push_char(out_ptr, out_size_ptr, '[')) {
+        return 0;
+    }
+
+    oijson_iterator iterator = oijson_iterator_create(array);
+    while (iterator.type != oijson_iterator_type_invalid) {
+        if (!oijson_internal_formatted_value(iterator.value, out_ptr, out_size_ptr)) {
+            return 0;
+        }
+        oijson_iterator_advance(&iterator);
+        if (iterator.type != oijson_iterator_type_invalid) {
+            if (!oijson_internal_push_char(out_ptr, out_size_ptr, ',')) {
+                return 0;
+            }
+        }
+    }
+
+    return oijson_internal_push_char(out_ptr, out_size_ptr, ']');
+}
+
+static int oijson_internal_formatted_string(oijson value, char** out_ptr, unsigned int* out_size_ptr) {
+    const char* itr = value.buffer;
+    unsigned int size = value.size;
+    do {
+        itr = oijson_internal_parse_char(itr, &size, out_ptr, out_size_ptr);
+        if (!itr) {
+            return 0;
+        }
+    } while (*itr != '\"');
+    return oijson_internal_push_char(out_ptr, out_size_ptr, '\"');
+}
+
+static int oijson_internal_formatted_value(oijson value, char** out_ptr, unsigned int* out_size_ptr) {
+    switch (value.type) {
+        case oijson_type_invalid:
+            return 0;
+        case oijson_type_object:
+            if (!oijson_internal_formatted_object(value, out_ptr, out_size_ptr)) {
+                return 0;
+            }
+            break;
+        case oijson_type_array:
+            if (!oijson_internal_formatted_array(value, out_ptr, out_size_ptr)) {
+                return 0;
+            }
+            break;
+        case oijson_type_string:
+            return oijson_internal_formatted_string(value, out_ptr, out_size_ptr);
+        default:
+            for (unsigned int i = 0; i < value.size; i++) {
+                if (!oijson_internal_push_char(out_ptr, out_size_ptr, value.buffer[i])) {
+                    return 0;
+                }
+            }
+            break;
+    }
+    return 1;
+}
+
+int oijson_value_formatted(oijson value, char* out, unsigned int out_size) {
+    if (!oijson_internal_pre_truncate(&out, &out_size)) {
+        return 0;
+    }
+
+    if (value.type == oijson_type_invalid) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    if (!oijson_internal_formatted_value(value, &out, &out_size)) {
+        return 0;
+    }
+    return out_size ? oijson_internal_push_char(&out, &out_size, '\0') : 1;
+}
+
+typedef struct oijson_internal_writer_s {
+    char* out;// used when write is not set
+    unsigned int out_size;
+    oijson_write_function write;
+    void* user_data;
+    char chunk[256];// batches small writes before calling write
+    unsigned int chunk_size;
+} oijson_internal_writer;
+
+static int oijson_internal_writer_flush(oijson_internal_writer* writer) {
+    if (writer->write && writer->chunk_size) {
+        if (!writer->write(writer->user_data, writer->chunk, writer->chunk_size)) {
+            oijson_internal_error_set("write failed");
+            return 0;
+        }
+        writer->chunk_size = 0;
+    }
+    return 1;
+}
+
+static int oijson_internal_writer_push(oijson_internal_writer* writer, const char* data, unsigned int size) {
+    if (!writer->write) {
+        int fits = size <= writer->out_size;
+        if (!fits) {
+            size = writer->out_size;// truncate
+        }
+        for (unsigned int i = 0; i < size; i++) {
+            writer->out[i] = data[i];
+        }
+        writer->out += size;
+        writer->out_size -= size;
+        if (!fits) {
+            oijson_internal_error_set("buffer too small");
+        }
+        return fits;
+    }
+
+    while (size) {
+        if (writer->chunk_size == sizeof(writer->chunk) && !oijson_internal_writer_flush(writer)) {
+            return 0;
+        }
+        unsigned int count = (unsigned int)sizeof(writer->chunk) - writer->chunk_size;
+        if (count > size) {
+            count = size;
+        }
+        for (unsigned int i = 0; i < count; i++) {
+            writer->chunk[writer->chunk_size + i] = data[i];
+        }
+        writer->chunk_size += count;
+        data += count;
+        size -= count;
+    }
+    return 1;
+}
+
+static int oijson_internal_minify_value(oijson value, oijson_internal_writer* writer) {// value is already validated, whitespace between tokens is dropped
+    const char* itr = value.buffer;
+    unsigned int size = value.size;
+    while (size) {
+        const char* start = itr;
+        while (size && !oijson_internal_is_whitespace(*itr)) {// copy everything up to the next whitespace in one push
+            if (*itr == '\"') {// strings are copied whole, whitespace inside them included
+                itr++;
+                size--;
+                while (1) {
+                    itr = oijson_internal_find_string_special(itr, &size);
+                    if (!size || *itr == '\"') {
+                        break;
+                    }
+                    itr++;// skip '\\' and the escaped character
+                    size--;
+                    if (size) {
+                        itr++;
+                        size--;
+                    }
+                }
+                if (!size) {
+                    break;
+                }
+            }
+            itr++;
+            size--;
+        }
+        if (itr != start && !oijson_internal_writer_push(writer, start, (unsigned int)(itr - start))) {
+            return 0;
+        }
+        while (size && oijson_internal_is_whitespace(*itr)) {
+            itr++;
+            size--;
+        }
+    }
+    return 1;
+}
+
+static int oijson_internal_pretty_newline(oijson_internal_writer* writer, unsigned int indent, unsigned int depth) {
+    static const char spaces[] = "                ";
+    const unsigned int spaces_size = sizeof(spaces) - 1;
+
+    if (!oijson_internal_writer_push(writer, "\n", 1)) {
+        return 0;
+    }
+    unsigned int count = indent * depth;
+    while (count) {
+        unsigned int step = count < spaces_size ? count : spaces_size;
+        if (!oijson_internal_writer_push(writer, spaces, step)) {
+            return 0;
+        }
+        count -= step;
+    }
+    return 1;
+}
+
+static int oijson_internal_pretty_value(oijson value, unsigned int indent, oijson_internal_writer* writer) {
+    const char* itr = value.buffer;
+    unsigned int size = value.size;
+    unsigned int depth = 0;
+
+    while (size) {// value is already validated, so a single pass over its bytes is enough
+        char c = *itr;
+        if (oijson_internal_is_whitespace(c)) {
+            itr++;
+            size--;
+            continue;
+        }
+
+        if (c == '\"') {// copy the whole string as is
+            const char* start = itr;
+            itr++;
+            size--;
+            while (1) {
+                itr = oijson_internal_find_string_special(itr, &size);
+                if (!size || *itr == '\"') {
+                    break;
+                }
+                itr++;// skip '\\' and the escaped character
+                size--;
+                if (size) {
+                    itr++;
+                    size--;
+                }
+            }
+            if (size) {
+                itr++;
+                size--;
+            }
+            if (!oijson_internal_writer_push(writer, start, (unsigned int)(itr - start))) {
+                return 0;
+            }
+            continue;
+        }
+
+        itr++;
+        size--;
+        switch (c) {
+            case '{':
+            case '[':
+                while (size && oijson_internal_is_whitespace(*itr)) {
+                    itr++;
+                    size--;
+                }
+                if (size && (*itr == '}' || *itr == ']')) {// empty object or array stays on one line
+                    if (!oijson_internal_writer_push(writer, &c, 1) || !oijson_internal_writer_push(writer, itr, 1)) {
+                        return 0;
+                    }
+                    itr++;
+                    size--;
+                    if (!depth) {
+                        return 1;
+                    }
+                    break;
+                }
+                depth++;
+                if (!oijson_internal_writer_push(writer, &c, 1) || !oijson_internal_pretty_newline(writer, indent, depth)) {
+                    return 0;
+                }
+                break;
+            case '}':
+            case ']':
+                depth--;
+                if (!oijson_internal_pretty_newline(writer, indent, depth) || !oijson_internal_writer_push(writer, &c, 1)) {
+                    return 0;
+                }
+                if (!depth) {// a lazily parsed value may extend past its closing bracket
+                    return 1;
+                }
+                break;
+            case ',':
+                if (!oijson_internal_writer_push(writer, &c, 1) || !oijson_internal_pretty_newline(writer, indent, depth)) {
+                    return 0;
+                }
+                break;
+            case ':':
+                if (!oijson_internal_writer_push(writer, ": ", 2)) {
+                    return 0;
+                }
+                break;
+            default:// numbers, true, false and null
+                if (!oijson_internal_writer_push(writer, &c, 1)) {
+                    return 0;
+                }
+                break;
+        }
+    }
+    return 1;
+}
+
+int oijson_value_pretty(oijson value, unsigned int indent, char* out, unsigned int out_size) {
+    if (!oijson_internal_pre_truncate(&out, &out_size)) {
+        return 0;
+    }
+
+    if (value.type == oijson_type_invalid) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = out;
+    writer.out_size = out_size;
+    writer.write = 0;
+    writer.user_data = 0;
+    writer.chunk_size = 0;
+    if (!oijson_internal_pretty_value(value, indent, &writer)) {
+        return 0;
+    }
+    return writer.out_size ? oijson_internal_push_char(&writer.out, &writer.out_size, '\0') : 1;
+}
+
+int oijson_value_pretty_write(oijson value, unsigned int indent, oijson_write_function write, void* user_data) {
+    if (!write) {
+        oijson_internal_error_set("invalid write function");
+        return 0;
+    }
+
+    if (value.type == oijson_type_invalid) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = 0;
+    writer.out_size = 0;
+    writer.write = write;
+    writer.user_data = user_data;
+    writer.chunk_size = 0;
+    return oijson_internal_pretty_value(value, indent, &writer) && oijson_internal_writer_flush(&writer);
+}
+
+static int oijson_internal_name_equals_name(oijson a, oijson b) {// compares two names, decoding escape sequences one character at a time
+    if (a.size == b.size) {
+        unsigned int i = 0;
+        while (i < a.size && a.buffer[i] == b.buffer[i]) {
+            i++;
+        }
+        if (i == a.size) {
+            return 1;
+        }
+    }
+
+    const char* itr_a = a.buffer + 1;
+    unsigned int size_a = a.size - 2;
+    const char* itr_b = b.buffer + 1;
+    unsigned int size_b = b.size - 2;
+    while (size_a && size_b) {
+        char decoded_a[4];
+        char decoded_b[4];
+        char* out_a = decoded_a;
+        char* out_b = decoded_b;
+        unsigned int out_size_a = sizeof(decoded_a);
+        unsigned int out_size_b = sizeof(decoded_b);
+        itr_a = oijson_internal_parse_char(itr_a, &size_a, &out_a, &out_size_a);
+        itr_b = oijson_internal_parse_char(itr_b, &size_b, &out_b, &out_size_b);
+        if (!itr_a || !itr_b || out_size_a != out_size_b) {
+            return 0;
+        }
+        for (unsigned int i = 0; i < sizeof(decoded_a) - out_size_a; i++) {
+            if (decoded_a[i] != decoded_b[i]) {
+                return 0;
+            }
+        }
+    }
+    return !size_a && !size_b;
+}
+
+static int oijson_internal_object_has_name(oijson object, oijson name) {
+    for (oijson_iterator iterator = oijson_iterator_create(object); iterator.type == oijson_iterator_type_object; oijson_iterator_advance(&iterator)) {
+        if (oijson_internal_name_equals_name(iterator.name, name)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#define OIJSON_MERGE_PATCH_SLOTS 64// hash slots for the names of one patch object, half of them are used so probes stay short
+
+static oijson_iterator oijson_internal_member_at(oijson object, unsigned int offset) {// reads the member whose name starts offset bytes into object
+    oijson_iterator member = {
+        .type = oijson_iterator_type_object,
+        .name = OIJSON_INVALID,
+        .value = OIJSON_INVALID,
+        .ptr = object.buffer + offset,
+        .size = object.size - offset,
+    };
+    oijson_internal_iterator_update(&member, 0);
+    return member;
+}
+
+static int oijson_internal_merge_patch_find(oijson_keyset_slot* slots, oijson patch, oijson name, unsigned int* slot) {// probes for name, leaving slot at the match or the empty slot ending the probe
+    unsigned long long name_hash;
+    if (!oijson_internal_string_hash(name, &name_hash)) {
+        return 0;
+    }
+    unsigned int hash = (unsigned int)name_hash;
+    *slot = hash & (OIJSON_MERGE_PATCH_SLOTS - 1);
+    while (slots[*slot].id >= 0) {
+        if (slots[*slot].hash == hash && oijson_internal_name_equals_name(oijson_internal_member_at(patch, (unsigned int)slots[*slot].id).name, name)) {
+            return 1;
+        }
+        *slot = (*slot + 1) & (OIJSON_MERGE_PATCH_SLOTS - 1);
+    }
+    slots[*slot].hash = hash;// kept for the caller to fill the slot
+    return 1;
+}
+
+// RFC 7386. Members of target that the patch does not touch are copied as is, including their whitespace.
+// The first OIJSON_MERGE_PATCH_SLOTS / 2 names of each patch object are hashed, so target members find them in constant time
+// and an object costs O(T + P). Names beyond those are found by scanning them, adding O(T * (P - 32)) for larger patch objects.
+static int oijson_internal_merge_patch(oijson target, oijson patch, oijson_internal_writer* writer) {
+    if (patch.type != oijson_type_object) {
+        return oijson_internal_writer_push(writer, patch.buffer, patch.size);
+    }
+    if (!oijson_internal_writer_push(writer, "{", 1)) {
+        return 0;
+    }
+
+    int first = 1;
+    oijson_keyset_slot slots[OIJSON_MERGE_PATCH_SLOTS];// ids are offsets of the patch names from the patch buffer
+    unsigned char member_slots[OIJSON_MERGE_PATCH_SLOTS / 2];// slot of each hashed patch member, by index
+    unsigned int hashed = 0;
+    unsigned long long matched = 0;// slots whose name was found in target
+    if (target.type == oijson_type_object) {
+        for (unsigned int i = 0; i < OIJSON_MERGE_PATCH_SLOTS; i++) {
+            slots[i].id = -1;
+        }
+        oijson_iterator patch_member = oijson_iterator_create(patch);
+        for (; patch_member.type == oijson_iterator_type_object && hashed < OIJSON_MERGE_PATCH_SLOTS / 2 && patch.size <= 0x7FFFFFFFu; oijson_iterator_advance(&patch_member)) {
+            unsigned int slot;
+            if (!oijson_internal_merge_patch_find(slots, patch, patch_member.name, &slot)) {
+                return 0;
+            }
+            if (slots[slot].id < 0) {// repeated names keep the first member
+                slots[slot].id = (int)(patch_member.name.buffer - patch.buffer);
+            }
+            member_slots[hashed++] = (unsigned char)slot;
+        }
+        int all_hashed = patch_member.type == oijson_iterator_type_invalid;
+
+        for (oijson_iterator member = oijson_iterator_create(target); member.type == oijson_iterator_type_object; oijson_iterator_advance(&member)) {
+            oijson patch_value = OIJSON_INVALID;
+            unsigned int slot;
+            if (!oijson_internal_merge_patch_find(slots, patch, member.name, &slot)) {
+                return 0;
+            }
+            if (slots[slot].id >= 0) {
+                patch_value = oijson_internal_member_at(patch, (unsigned int)slots[slot].id).value;
+                matched |= 1ULL << slot;
+            }
+            else if (!all_hashed) {// the name may be among the members that were not hashed
+                unsigned int index = 0;
+                for (oijson_iterator patch_member = oijson_iterator_create(patch); patch_member.type == oijson_iterator_type_object; oijson_iterator_advance(&patch_member), index++) {
+                    if (index >= hashed && oijson_internal_name_equals_name(member.name, patch_member.name)) {
+                        patch_value = patch_member.value;
+                        break;
+                    }
+                }
+            }
+
+            if (patch_value.type == oijson_type_null) {// removed
+                continue;
+            }
+            if (!first && !oijson_internal_writer_push(writer, ",", 1)) {
+                return 0;
+            }
+            first = 0;
+            if (patch_value.type == oijson_type_invalid) {// untouched, copy from the name to the end of the value
+                if (!oijson_internal_writer_push(writer, member.name.buffer, (unsigned int)(member.value.buffer + member.value.size - member.name.buffer))) {
+                    return 0;
+                }
+                continue;
+            }
+            if (!oijson_internal_writer_push(writer, member.name.buffer, member.name.size)
+                || !oijson_internal_writer_push(writer, ":", 1)
+                || !oijson_internal_merge_patch(member.value, patch_value, writer)) {
+                return 0;
+            }
+        }
+    }
+
+    unsigned int index = 0;
+    for (oijson_iterator patch_member = oijson_iterator_create(patch); patch_member.type == oijson_iterator_type_object; oijson_iterator_advance(&patch_member), index++) {
+        if (patch_member.value.type == oijson_type_null) {
+            continue;
+        }
+        if (target.type == oijson_type_object &&
+            (index < hashed ? ((matched >> member_slots[index]) & 1) != 0 : oijson_internal_object_has_name(target, patch_member.name))) {
+            continue;
+        }
+        if (!first && !oijson_internal_writer_push(writer, ",", 1)) {
+            return 0;
+        }
+        first = 0;
+        if (!oijson_internal_writer_push(writer, patch_member.name.buffer, patch_member.name.size)
+            || !oijson_internal_writer_push(writer, ":", 1)
+            || !oijson_internal_merge_patch(OIJSON_INVALID, patch_member.value, writer)) {// added, nulls inside are dropped
+            return 0;
+        }
+    }
+    return oijson_internal_writer_push(writer, "}", 1);
+}
+
+int oijson_merge_patch(oijson target, oijson patch, char* out, unsigned int out_size) {
+    if (!oijson_internal_pre_truncate(&out, &out_size)) {
+        return 0;
+    }
+
+    if (target.type == oijson_type_invalid || patch.type == oijson_type_invalid) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = out;
+    writer.out_size = out_size;
+    writer.write = 0;
+    writer.user_data = 0;
+    writer.chunk_size = 0;
+    if (!oijson_internal_merge_patch(target, patch, &writer)) {
+        return 0;
+    }
+    return writer.out_size ? oijson_internal_push_char(&writer.out, &writer.out_size, '\0') : 1;
+}
+
+int oijson_merge_patch_write(oijson target, oijson patch, oijson_write_function write, void* user_data) {
+    if (!write) {
+        oijson_internal_error_set("invalid write function");
+        return 0;
+    }
+
+    if (target.type == oijson_type_invalid || patch.type == oijson_type_invalid) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = 0;
+    writer.out_size = 0;
+    writer.write = write;
+    writer.user_data = user_data;
+    writer.chunk_size = 0;
+    return oijson_internal_merge_patch(target, patch, &writer) && oijson_internal_writer_flush(&writer);
+}
+
+#define OIJSON_PROJECT_MAX_PATHS 64// one bit per path in the active mask
+
+typedef struct oijson_internal_project_frame_s {// an object or array that is only written once something inside it is kept
+    struct oijson_internal_project_frame_s* parent;
+    oijson name;// invalid for array elements and the root
+    char open;
+    int opened;
+    unsigned int written;// children written so far
+} oijson_internal_project_frame;
+
+static int oijson_internal_project_open(oijson_internal_project_frame* frame, oijson_internal_writer* writer) {// writes frame and its ancestors, if not written yet
+    if (frame->opened) {
+        return 1;
+    }
+    oijson_internal_project_frame* parent = frame->parent;
+    if (parent) {
+        if (!oijson_internal_project_open(parent, writer) || (parent->written && !oijson_internal_writer_push(writer, ",", 1))) {
+            return 0;
+        }
+        if (frame->name.type == oijson_type_string &&
+            (!oijson_internal_writer_push(writer, frame->name.buffer, frame->name.size) || !oijson_internal_writer_push(writer, ":", 1))) {
+            return 0;
+        }
+        parent->written++;
+    }
+    frame->opened = 1;
+    return oijson_internal_writer_push(writer, &frame->open, 1);
+}
+
+static int oijson_internal_pointer_segment(const char* path, unsigned int depth, const char** out, unsigned int* out_size) {// segment number depth of a JSON pointer
+    *out = path;
+    *out_size = 0;
+    for (unsigned int i = 0; i <= depth; i++) {
+        if (*path != '/') {
+            return 0;
+        }
+        path++;
+        *out = path;
+        while (*path && *path != '/') {
+            path++;
+        }
+    }
+    *out_size = (unsigned int)(path - *out);
+    return 1;
+}
+
+static int oijson_internal_segment_equals_name(const char* segment, unsigned int segment_size, oijson name) {// '~0' and '~1' stand for '~' and '/'
+    const char* itr = name.buffer + 1;
+    unsigned int size = name.size - 2;
+    unsigned int i = 0;
+    while (size) {
+        char decoded[4];
+        char* decoded_itr = decoded;
+        unsigned int decoded_size = sizeof(decoded);
+        if (*itr != '\\') {// plain bytes need no decoding
+            decoded[0] = *itr++;
+            decoded_itr++;
+            size--;
+        }
+        else if (!(itr = oijson_internal_parse_char(itr, &size, &decoded_itr, &decoded_size))) {
+            return 0;
+        }
+        for (const char* c = decoded; c != decoded_itr; c++) {
+            if (i == segment_size) {
+                return 0;
+            }
+            char expected = segment[i++];
+            if (expected == '~') {
+                expected = segment[i] == '0' ? '~' : '/';// paths are checked up front, '~' is always followed by '0' or '1'
+                i++;
+            }
+            if (expected != *c) {
+                return 0;
+            }
+        }
+    }
+    return i == segment_size;
+}
+
+static int oijson_internal_segment_index(const char* segment, unsigned int segment_size, unsigned int* out) {// array index without leading zeros
+    if (!segment_size || segment_size > 10 || (segment[0] == '0' && segment_size > 1)) {
+        return 0;
+    }
+    unsigned long long value = 0;
+    for (unsigned int i = 0; i < segment_size; i++) {
+        if (!oijson_internal_is_digit(segment[i])) {
+            return 0;
+        }
+        value = value * 10 + (unsigned long long)(segment[i] - '0');
+    }
+    if (value > 0xFFFFFFFFu) {
+        return 0;
+    }
+    *out = (unsigned int)value;
+    return 1;
+}
+
+static int oijson_internal_segment_equals_index(const char* segment, unsigned int segment_size, unsigned int index) {
+    unsigned int value;
+    return oijson_internal_segment_index(segment, segment_size, &value) && value == index;
+}
+
+static int oijson_internal_pointer_valid(const char* path) {// "" or segments each starting with '/', where '~' is always followed by '0' or '1'
+    if (!path || (*path && *path != '/')) {
+        return 0;
+    }
+    for (const char* c = path; *c; c++) {
+        if (*c == '~' && c[1] != '0' && c[1] != '1') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int oijson_internal_project(oijson_internal_project_frame* frame, oijson value, const char* const* paths, unsigned long long active, unsigned int depth, oijson_internal_writer* writer) {
+    unsigned int index = 0;
+    for (oijson_iterator iterator = oijson_iterator_create(value); iterator.type != oijson_iterator_type_invalid; oijson_iterator_advance(&iterator), index++) {
+        unsigned long long matched = 0;// paths that continue into this child
+        int keep = 0;// a path ends at this child, which is kept as a whole
+        for (unsigned int i = 0; i < OIJSON_PROJECT_MAX_PATHS; i++) {
+            if (!((active >> i) & 1)) {
+                continue;
+            }
+            const char* segment;
+            unsigned int segment_size;
+            if (!oijson_internal_pointer_segment(paths[i], depth, &segment, &segment_size)) {
+                continue;
+            }
+            int equal = iterator.type == oijson_iterator_type_object ?
+                oijson_internal_segment_equals_name(segment, segment_size, iterator.name) :
+                oijson_internal_segment_equals_index(segment, segment_size, index);
+            if (equal) {
+                keep = keep || !segment[segment_size];
+                matched |= 1ULL << i;
+            }
+        }
+
+        if (keep) {
+            if (!oijson_internal_project_open(frame, writer) || (frame->written && !oijson_internal_writer_push(writer, ",", 1))) {
+                return 0;
+            }
+            if (iterator.type == oijson_iterator_type_object &&
+                (!oijson_internal_writer_push(writer, iterator.name.buffer, iterator.name.size) || !oijson_internal_writer_push(writer, ":", 1))) {
+                return 0;
+            }
+            if (!oijson_internal_minify_value(iterator.value, writer)) {
+                return 0;
+            }
+            frame->written++;
+        }
+        else if (matched && (iterator.value.type == oijson_type_object || iterator.value.type == oijson_type_array)) {
+            oijson_internal_project_frame child = {
+                .parent = frame,
+                .name = iterator.type == oijson_iterator_type_object ? iterator.name : OIJSON_INVALID,
+                .open = iterator.value.type == oijson_type_object ? '{' : '[',
+                .opened = 0,
+                .written = 0,
+            };
+            if (!oijson_internal_project(&child, iterator.value, paths, matched, depth + 1, writer)) {
+                return 0;
+            }
+            if (child.opened && !oijson_internal_writer_push(writer, child.open == '{' ? "}" : "]", 1)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static int oijson_internal_project_root(oijson value, const char* const* paths, unsigned int path_count, oijson_internal_writer* writer) {
+    if (value.type != oijson_type_object && value.type != oijson_type_array) {
+        oijson_internal_error_set("value is not an object or array");
+        return 0;
+    }
+    if (!paths || path_count > OIJSON_PROJECT_MAX_PATHS) {
+        oijson_internal_error_set("too many paths");
+        return 0;
+    }
+
+    unsigned long long active = 0;
+    for (unsigned int i = 0; i < path_count; i++) {
+        if (!oijson_internal_pointer_valid(paths[i])) {
+            oijson_internal_error_set("invalid path");
+            return 0;
+        }
+        if (!*paths[i]) {// the whole document
+            return oijson_internal_minify_value(value, writer);
+        }
+        active |= 1ULL << i;
+    }
+
+    oijson_internal_project_frame root = {
+        .parent = 0,
+        .name = OIJSON_INVALID,
+        .open = value.type == oijson_type_object ? '{' : '[',
+        .opened = 0,
+        .written = 0,
+    };
+    return oijson_internal_project_open(&root, writer) && oijson_internal_project(&root, value, paths, active, 0, writer) &&
+        oijson_internal_writer_push(writer, root.open == '{' ? "}" : "]", 1);
+}
+
+int oijson_project(oijson value, const char* const* paths, unsigned int path_count, char* out, unsigned int out_size) {
+    if (!oijson_internal_pre_truncate(&out, &out_size)) {
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = out;
+    writer.out_size = out_size;
+    writer.write = 0;
+    writer.user_data = 0;
+    writer.chunk_size = 0;
+    if (!oijson_internal_project_root(value, paths, path_count, &writer)) {
+        return 0;
+    }
+    return writer.out_size ? oijson_internal_push_char(&writer.out, &writer.out_size, '\0') : 1;
+}
+
+int oijson_project_write(oijson value, const char* const* paths, unsigned int path_count, oijson_write_function write, void* user_data) {
+    if (!write) {
+        oijson_internal_error_set("invalid write function");
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = 0;
+    writer.out_size = 0;
+    writer.write = write;
+    writer.user_data = user_data;
+    writer.chunk_size = 0;
+    return oijson_internal_project_root(value, paths, path_count, &writer) && oijson_internal_writer_flush(&writer);
+}
+
+#define OIJSON_JSON_PATCH_MAX_PATH 256// bytes of a decoded "path" or "from", with the null terminator
+#define OIJSON_JSON_PATCH_EDITS 2// a move removes one value and adds another in the same pass
+
+typedef struct oijson_internal_patch_edit_s {
+    const char* path;// decoded JSON pointer to the changed value
+    unsigned int depth;// segments in path
+    oijson value;// written at path, invalid to remove the value found there
+    int add;// missing object members are appended, array elements are inserted before the index
+    int done;
+} oijson_internal_patch_edit;
+
+static unsigned int oijson_internal_pointer_depth(const char* path) {
+    unsigned int depth = 0;
+    for (; *path; path++) {
+        depth += *path == '/';
+    }
+    return depth;
+}
+
+static oijson oijson_internal_pointer_resolve(oijson value, const char* path, unsigned int depth) {// value at the first depth segments of path, invalid if there is none
+    for (unsigned int i = 0; i < depth && value.type != oijson_type_invalid; i++) {
+        const char* segment;
+        unsigned int segment_size;
+        oijson_internal_pointer_segment(path, i, &segment, &segment_size);
+        oijson child = OIJSON_INVALID;
+        unsigned int index = 0;
+        for (oijson_iterator iterator = oijson_iterator_create(value); iterator.type != oijson_iterator_type_invalid; oijson_iterator_advance(&iterator), index++) {
+            if (iterator.type == oijson_iterator_type_object ?
+                oijson_internal_segment_equals_name(segment, segment_size, iterator.name) :
+                oijson_internal_segment_equals_index(segment, segment_size, index)) {
+                child = iterator.value;
+                break;
+            }
+        }
+        value = child;
+    }
+    return value;
+}
+
+static int oijson_internal_write_segment_name(const char* segment, unsigned int segment_size, oijson_internal_writer* writer) {// writes a pointer segment as a JSON string
+    static const char hex[] = "0123456789abcdef";
+    if (!oijson_internal_writer_push(writer, "\"", 1)) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < segment_size; i++) {
+        char c = segment[i];
+        if (c == '~') {
+            c = segment[++i] == '0' ? '~' : '/';
+        }
+        char escaped[6] = { '\\', c, 0, 0, 0, 0 };
+        unsigned int escaped_size = 2;
+        if ((unsigned char)c < 0x20) {
+            escaped[1] = 'u';
+            escaped[2] = '0';
+            escaped[3] = '0';
+            escaped[4] = hex[(unsigned char)c >> 4];
+            escaped[5] = hex[(unsigned char)c & 0xF];
+            escaped_size = 6;
+        }
+        else if (c != '\"' && c != '\\') {
+            escaped[0] = c;
+            escaped_size = 1;
+        }
+        if (!oijson_internal_writer_push(writer, escaped, escaped_size)) {
+            return 0;
+        }
+    }
+    return oijson_internal_writer_push(writer, "\"", 1);
+}
+
+static int oijson_internal_patch_separator(unsigned int* written, oijson_internal_writer* writer) {
+    return !(*written)++ || oijson_internal_writer_push(writer, ",", 1);
+}
+
+// Writes value with the active edits applied below it. Elements on no edit path are copied as is, so the cost is one pass over value
+static int oijson_internal_patch_rewrite(oijson value, oijson_internal_patch_edit* edits, unsigned int active, unsigned int depth, oijson_internal_writer* writer) {
+    int object = value.type == oijson_type_object;
+    if (!active || (!object && value.type != oijson_type_array)) {// edits below a scalar are never done, so they fail
+        return oijson_internal_writer_push(writer, value.buffer, value.size);
+    }
+    if (!oijson_internal_writer_push(writer, object ? "{" : "[", 1)) {
+        return 0;
+    }
+
+    unsigned int written = 0;
+    unsigned int index = 0;
+    for (oijson_iterator iterator = oijson_iterator_create(value); iterator.type != oijson_iterator_type_invalid; oijson_iterator_advance(&iterator), index++) {
+        unsigned int below = 0;// edits continuing inside this element
+        int removed = 0;
+        oijson replacement = iterator.value;
+        for (unsigned int i = 0; i < OIJSON_JSON_PATCH_EDITS; i++) {
+            const char* segment;
+            unsigned int segment_size;
+            if (!((active >> i) & 1) || !oijson_internal_pointer_segment(edits[i].path, depth, &segment, &segment_size)) {
+                continue;
+            }
+            if (!(object ? oijson_internal_segment_equals_name(segment, segment_size, iterator.name) : oijson_internal_segment_equals_index(segment, segment_size, index))) {
+                continue;
+            }
+            if (edits[i].depth > depth + 1) {
+                below |= 1u << i;
+                continue;
+            }
+            edits[i].done = 1;
+            if (!object && edits[i].add) {// inserted before this element
+                if (!oijson_internal_patch_separator(&written, writer) || !oijson_internal_writer_push(writer, edits[i].value.buffer, edits[i].value.size)) {
+                    return 0;
+                }
+            }
+            else if (edits[i].value.type == oijson_type_invalid) {
+                removed = 1;
+            }
+            else {
+                replacement = edits[i].value;
+            }
+        }
+
+        int changed = removed || replacement.buffer != iterator.value.buffer;
+        for (unsigned int i = 0; i < OIJSON_JSON_PATCH_EDITS; i++) {// edits inside a removed or replaced element have nothing left to change
+            if (changed && ((below >> i) & 1)) {
+                edits[i].done = 1;
+            }
+        }
+        if (removed) {
+            continue;
+        }
+        if (!oijson_internal_patch_separator(&written, writer)) {
+            return 0;
+        }
+        if (!changed && !below) {// untouched, copy from the name to the end of the value
+            const char* start = object ? iterator.name.buffer : iterator.value.buffer;
+            if (!oijson_internal_writer_push(writer, start, (unsigned int)(iterator.value.buffer + iterator.value.size - start))) {
+                return 0;
+            }
+            continue;
+        }
+        if (object && (!oijson_internal_writer_push(writer, iterator.name.buffer, iterator.name.size) || !oijson_internal_writer_push(writer, ":", 1))) {
+            return 0;
+        }
+        if (!(changed ? oijson_internal_writer_push(writer, replacement.buffer, replacement.size) : oijson_internal_patch_rewrite(iterator.value, edits, below, depth + 1, writer))) {
+            return 0;
+        }
+    }
+
+    for (unsigned int i = 0; i < OIJSON_JSON_PATCH_EDITS; i++) {// new members and elements appended at the end, where index is the element count
+        const char* segment;
+        unsigned int segment_size;
+        if (!((active >> i) & 1) || edits[i].done || !edits[i].add || edits[i].depth != depth + 1) {
+            continue;
+        }
+        oijson_internal_pointer_segment(edits[i].path, depth, &segment, &segment_size);
+        if (!object && !(segment_size == 1 && segment[0] == '-') && !oijson_internal_segment_equals_index(segment, segment_size, index)) {
+            continue;
+        }
+        if (!oijson_internal_patch_separator(&written, writer)) {
+            return 0;
+        }
+        if (object && (!oijson_internal_write_segment_name(segment, segment_size, writer) || !oijson_internal_writer_push(writer, ":", 1))) {
+            return 0;
+        }
+        if (!oijson_internal_writer_push(writer, edits[i].value.buffer, edits[i].value.size)) {
+            return 0;
+        }
+        edits[i].done = 1;
+    }
+    return oijson_internal_writer_push(writer, object ? "}" : "]", 1);
+}
+
+static int oijson_internal_patch_path(oijson operation, const char* name, char* out) {// decodes the pointer held by member name
+    oijson path = oijson_object_value_by_name(operation, name);
+    if (path.type != oijson_type_string) {
+        oijson_internal_error_set("invalid patch operation");
+        return 0;
+    }
+    out[0] = '\0';
+    if (path.size > 2 && !oijson_value_as_string(path, out, OIJSON_JSON_PATCH_MAX_PATH)) {
+        return 0;
+    }
+    if (!oijson_internal_pointer_valid(out)) {
+        oijson_internal_error_set("invalid path");
+        return 0;
+    }
+    return 1;
+}
+
+// Applies one RFC 6902 operation to document. Test operations write nothing, the others write the whole patched document
+static int oijson_internal_json_patch_operation(oijson document, oijson operation, oijson_internal_writer* writer) {
+    oijson op = oijson_object_value_by_name(operation, "op");
+    char path[OIJSON_JSON_PATCH_MAX_PATH];
+    char from[OIJSON_JSON_PATCH_MAX_PATH];
+    char shifted[OIJSON_JSON_PATCH_MAX_PATH];// path of a move, in the document still holding the moved value
+    if (op.type != oijson_type_string || !oijson_internal_patch_path(operation, "path", path)) {
+        oijson_internal_error_set("invalid patch operation");
+        return 0;
+    }
+    int moved = oijson_internal_name_equals(op, "move");
+    int copied = oijson_internal_name_equals(op, "copy");
+    int removed = oijson_internal_name_equals(op, "remove");
+    oijson value = OIJSON_INVALID;
+    if (moved || copied) {
+        if (!oijson_internal_patch_path(operation, "from", from)) {
+            return 0;
+        }
+        value = oijson_internal_pointer_resolve(document, from, oijson_internal_pointer_depth(from));
+    }
+    else if (!removed) {
+        value = oijson_object_value_by_name(operation, "value");
+    }
+    if (!removed && value.type == oijson_type_invalid) {
+        oijson_internal_error_set(moved || copied ? "path not found" : "invalid patch operation");
+        return 0;
+    }
+
+    if (oijson_internal_name_equals(op, "test")) {
+        oijson found = oijson_internal_pointer_resolve(document, path, oijson_internal_pointer_depth(path));
+        if (found.type == oijson_type_invalid) {
+            oijson_internal_error_set("path not found");
+            return 0;
+        }
+        if (!oijson_equal(found, value)) {
+            oijson_internal_error_set("test failed");
+            return 0;
+        }
+        return 1;
+    }
+
+    oijson_internal_patch_edit edits[OIJSON_JSON_PATCH_EDITS] = {
+        { .path = path, .depth = oijson_internal_pointer_depth(path), .value = value, .add = 0, .done = 0 },
+        { .path = "", .depth = 0, .value = OIJSON_INVALID, .add = 0, .done = 1 },
+    };
+    unsigned int active = 1;
+    if (oijson_internal_name_equals(op, "add") || copied) {
+        edits[0].add = 1;
+    }
+    else if (moved) {
+        unsigned int from_size = 0;
+        while (from[from_size]) {
+            from_size++;
+        }
+        unsigned int i = 0;
+        while (i < from_size && path[i] == from[i]) {
+            i++;
+        }
+        if (i == from_size && !path[i]) {// moved onto itself
+            return oijson_internal_writer_push(writer, document.buffer, document.size);
+        }
+        if (i == from_size && path[i] == '/') {
+            oijson_internal_error_set("invalid path");// a value cannot move into itself
+            return 0;
+        }
+
+        // path is meant for the document without the moved value. Within the same array, indices past it are shifted back by one,
+        // so one more is added to find the same place in document, where the value is still present
+        unsigned int from_depth = oijson_internal_pointer_depth(from);
+        const char* from_segment;
+        unsigned int from_segment_size;
+        oijson_internal_pointer_segment(from, from_depth - 1, &from_segment, &from_segment_size);
+        unsigned int parent_size = (unsigned int)(from_segment - from);
+        unsigned int from_index;
+        const char* segment;
+        unsigned int segment_size;
+        unsigned int index;
+        i = 0;
+        while (i < parent_size && path[i] == from[i]) {
+            i++;
+        }
+        if (i == parent_size && oijson_internal_pointer_segment(path, from_depth - 1, &segment, &segment_size) &&
+            oijson_internal_segment_index(from_segment, from_segment_size, &from_index) && oijson_internal_segment_index(segment, segment_size, &index) &&
+            index >= from_index && oijson_internal_pointer_resolve(document, from, from_depth - 1).type == oijson_type_array) {
+            unsigned int digits = 1;
+            for (unsigned int power = 10; power <= index + 1 && digits < 10; power *= 10) {
+                digits++;
+            }
+            unsigned int rest = 0;
+            while (segment[segment_size + rest]) {
+                rest++;
+            }
+            if (parent_size + digits + rest >= sizeof(shifted)) {
+                oijson_internal_error_set("buffer too small");
+                return 0;
+            }
+            for (i = 0; i < parent_size; i++) {
+                shifted[i] = path[i];
+            }
+            for (unsigned int next = index + 1, d = digits; d; d--, next /= 10) {
+                shifted[parent_size + d - 1] = (char)('0' + next % 10);
+            }
+            for (i = 0; i <= rest; i++) {
+                shifted[parent_size + digits + i] = segment[segment_size + i];
+            }
+            edits[0].path = shifted;
+        }
+        edits[0].add = 1;
+        edits[1] = (oijson_internal_patch_edit) { .path = from, .depth = from_depth, .value = OIJSON_INVALID, .add = 0, .done = 0 };
+        active = 3;
+    }
+    else if (!removed && !oijson_internal_name_equals(op, "replace")) {
+        oijson_internal_error_set("invalid patch operation");
+        return 0;
+    }
+
+    if (!edits[0].depth) {// the root is replaced, anything removed from it no longer matters
+        if (removed) {
+            oijson_internal_error_set("invalid path");// nothing would be left
+            return 0;
+        }
+        return oijson_internal_writer_push(writer, value.buffer, value.size);
+    }
+    if (!oijson_internal_patch_rewrite(document, edits, active, 0, writer)) {
+        return 0;
+    }
+    if (!edits[0].done || !edits[1].done) {
+        oijson_internal_error_set("path not found");
+        return 0;
+    }
+    return 1;
+}
+
+int oijson_json_patch(oijson target, oijson patch, char* out, unsigned int out_size, char* scratch, unsigned int scratch_size) {
+    if (!out || !oijson_internal_pre_truncate(&out, &out_size)) {
+        return 0;
+    }
+    if (target.type == oijson_type_invalid || patch.type != oijson_type_array) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    unsigned int writes = 0;// operations that write a document, the last one must write to out
+    for (oijson_iterator iterator = oijson_iterator_create(patch); iterator.type != oijson_iterator_type_invalid; oijson_iterator_advance(&iterator)) {
+        oijson op = oijson_object_value_by_name(iterator.value, "op");
+        if (op.type != oijson_type_string) {
+            oijson_internal_error_set("invalid patch operation");
+            return 0;
+        }
+        writes += !oijson_internal_name_equals(op, "test");
+    }
+    if (writes > 1 && !scratch) {
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+
+    oijson_internal_writer writer;
+    writer.out = out;
+    writer.out_size = out_size;
+    writer.write = 0;
+    writer.user_data = 0;
+    writer.chunk_size = 0;
+    oijson document = target;
+    for (oijson_iterator iterator = oijson_iterator_create(patch); iterator.type != oijson_iterator_type_invalid; oijson_iterator_advance(&iterator)) {
+        if (oijson_internal_name_equals(oijson_object_value_by_name(iterator.value, "op"), "test")) {
+            if (!oijson_internal_json_patch_operation(document, iterator.value, &writer)) {
+                return 0;
+            }
+            continue;
+        }
+        char* buffer = writes-- % 2 ? out : scratch;// alternates so each document is read from the other buffer
+        writer.out = buffer;
+        writer.out_size = buffer == out ? out_size : scratch_size;
+        if (!oijson_internal_json_patch_operation(document, iterator.value, &writer)) {
+            return 0;
+        }
+        document = oijson_parse(buffer, (unsigned int)(writer.out - buffer));
+        if (document.type == oijson_type_invalid) {
+            return 0;
+        }
+    }
+    if (document.buffer == target.buffer && !oijson_internal_writer_push(&writer, target.buffer, target.size)) {// only tests
+        return 0;
+    }
+    return writer.out_size ? oijson_internal_push_char(&writer.out, &writer.out_size, '\0') : 1;
+}
+
+int oijson_value_as_string(oijson value, char* out, unsigned int out_size) {
+    if (!oijson_internal_pre_truncate(&out, &out_size)) {
+        return 0;
+    }
+
+    if (value.type != oijson_type_string) {
+        oijson_internal_error_set("value is not a string");
+        return 0;
+    }
+
+    const char* itr = value.buffer + 1;
+    unsigned int size = value.size - 1;
+    do {
+        itr = oijson_internal_parse_char(itr, &size, &out, &out_size);
+        if (!itr) {
+            return 0;
+        }
+    } while (*itr != '\"');
+    return out_size ? oijson_internal_push_char(&out, &out_size, '\0') : 1;
+}
+
+static const char* oijson_internal_parse_ull(const char* string, unsigned int string_size, unsigned long long* out) {
+    string = oijson_internal_consume_whitespace(string, &string_size);
+    if(!string || !string_size) {
+        return OIJSON_NULLCHAR;
+    }
+
+    const char* ptr = string;//due to previous checks, ptr is guaranteed to be a number here
+    unsigned long long value = 0;
+    do {
+        value = value * 10 + (unsigned long long)(*ptr - '0');
+        ptr++;
+        string_size--;
+    } while (string_size && ptr[0] >= '0' && ptr[0] <= '9');
+
+    if(out) {
+        *out = value;
+    }
+    return ptr;
+}
+
+static const char* oijson_internal_parse_ll(const char* string, unsigned int string_size, long long* out) {
+    string = oijson_internal_consume_whitespace(string, &string_size);
+    if (!string || !string_size) {
+        return OIJSON_NULLCHAR;
+    }
+
+    int negative = *string == '-';
+    if (negative || *string == '+') {// exponents may have an explicit sign
+        string++;
+        string_size--;
+    }
+    unsigned long long ull = 0;
+    const char* ptr = oijson_internal_parse_ull(string, string_size, &ull);
+    if(ptr && out) {
+        *out = (long long)ull;
+        if (negative) {
+            *out = -(*out);
+        }
+    }
+    return ptr;
+}
+
+static int oijson_internal_digits_fit(const char* digits, unsigned int digit_count, const char* limit, unsigned int limit_size) {// digits without leading zeros are at most limit
+    if (digit_count != limit_size) {
+        return digit_count < limit_size;
+    }
+    unsigned int i = 0;
+    while (i < digit_count && digits[i] == limit[i]) {
+        i++;
+    }
+    return i == digit_count || digits[i] < limit[i];
+}
+
+typedef struct oijson_internal_number_s {// parts of a number, as found by oijson_internal_consume_number_info
+    const char* integer;
+    unsigned int integer_size;
+    const char* fraction;
+    unsigned int fraction_size;
+    const char* exponent;
+    unsigned int exponent_size;
+} oijson_internal_number;
+
+static const char* oijson_internal_consume_number_parts(const char* itr, unsigned int* size, oijson_internal_number* out) {
+    out->integer = OIJSON_NULLCHAR;
+    out->fraction = OIJSON_NULLCHAR;
+    out->exponent = OIJSON_NULLCHAR;
+    return oijson_internal_consume_number_info(itr, size, &out->integer, &out->integer_size, &out->fraction, &out->fraction_size, &out->exponent, &out->exponent_size);
+}
+
+static int oijson_internal_value_number(oijson value, oijson_internal_number* out) {// the whole value must be one number, lazy values end where scanning stopped
+    unsigned int size = value.size;
+    if (!oijson_internal_consume_number_parts(value.buffer, &size, out)) {
+        return 0;
+    }
+    if (size) {
+        oijson_internal_error_set("invalid number");
+        return 0;
+    }
+    return 1;
+}
+
+typedef struct oijson_internal_decimal_s {// exact value of a number, 0.digits * 10^exponent without leading or trailing zeros
+    int negative;
+    const char* integer;// significant digits before the decimal point, followed by the ones after it
+    unsigned int integer_size;
+    const char* fraction;
+    unsigned int fraction_size;
+    long long exponent;
+    const char* long_exponent;// digits of an exponent too long for exponent, which then only holds the position of the decimal point
+    unsigned int long_exponent_size;
+    int long_exponent_negative;
+} oijson_internal_decimal;
+
+static void oijson_internal_number_decimal(const oijson_internal_number* number, oijson_internal_decimal* out) {// zero is always positive, so -0 equals 0
+    out->negative = number->integer[0] == '-';
+    out->integer = number->integer + out->negative;
+    out->integer_size = 0;
+    while (out->integer_size < number->integer_size - (unsigned int)out->negative && oijson_internal_is_digit(out->integer[out->integer_size])) {
+        out->integer_size++;
+    }
+    out->fraction = number->fraction;
+    out->fraction_size = 0;
+    while (number->fraction && out->fraction_size < number->fraction_size && oijson_internal_is_digit(out->fraction[out->fraction_size])) {
+        out->fraction_size++;
+    }
+    out->exponent = 0;
+    out->long_exponent = OIJSON_NULLCHAR;
+    out->long_exponent_size = 0;
+    out->long_exponent_negative = 0;
+
+    if (out->integer[0] == '0') {// a leading zero is always alone, the first significant digit may be in the fraction
+        out->integer_size = 0;
+        while (out->fraction_size && out->fraction[0] == '0') {
+            out->fraction++;
+            out->fraction_size--;
+            out->exponent--;
+        }
+    }
+    else {
+        out->exponent = out->integer_size;
+    }
+    while (out->fraction_size && out->fraction[out->fraction_size - 1] == '0') {
+        out->fraction_size--;
+    }
+    while (!out->fraction_size && out->integer_size && out->integer[out->integer_size - 1] == '0') {
+        out->integer_size--;
+    }
+    if (!out->integer_size && !out->fraction_size) {
+        out->negative = 0;
+        out->exponent = 0;
+        return;
+    }
+
+    if (number->exponent) {
+        const char* digits = number->exponent;
+        unsigned int digit_count = 0;
+        int negative = *digits == '-';
+        if (negative || *digits == '+') {
+            digits++;
+        }
+        while (digit_count < number->exponent_size - (unsigned int)(digits - number->exponent) && oijson_internal_is_digit(digits[digit_count])) {
+            digit_count++;
+        }
+        while (digit_count > 1 && digits[0] == '0') {
+            digits++;
+            digit_count--;
+        }
+        if (digit_count > 18) {// such numbers only match the same digits with the decimal point at the same place
+            out->long_exponent = digits;
+            out->long_exponent_size = digit_count;
+            out->long_exponent_negative = negative;
+            return;
+        }
+        long long exponent = 0;
+        oijson_internal_parse_ll(digits, digit_count, &exponent);
+        out->exponent += negative ? -exponent : exponent;
+    }
+}
+
+static long double oijson_internal_power_of_ten(unsigned int n) {// exact up to 10^22, or 10^27 with a 64-bit long double mantissa
+    long double result = 1.0L;
+    long double base = 10.0L;
+    while (n) {
+        if (n & 1) {
+            result *= base;
+        }
+        base *= base;
+        n >>= 1;
+    }
+    return result;
+}
+
+// Up to 19 significant digits, rounded on the 20th, scaled by one power of ten. With at most 15 digits and a
+// power of ten up to 10^22 both operands are exact, so the result is correctly rounded (Clinger's fast path).
+// Otherwise it is within a few units in the last place.
+static double oijson_internal_decimal_to_double(const oijson_internal_decimal* decimal) {
+    unsigned int size = decimal->integer_size + decimal->fraction_size;
+    if (!size) {
+        return 0.0;
+    }
+    if (decimal->long_exponent) {
+        double saturated = decimal->long_exponent_negative ? 0.0 : (double)oijson_internal_power_of_ten(800);// 0 or infinity
+        return decimal->negative ? -saturated : saturated;
+    }
+
+    unsigned int count = size < 19 ? size : 19;
+    unsigned long long significand = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        char digit = i < decimal->integer_size ? decimal->integer[i] : decimal->fraction[i - decimal->integer_size];
+        significand = significand * 10 + (unsigned long long)(digit - '0');
+    }
+    if (size > count && (count < decimal->integer_size ? decimal->integer[count] : decimal->fraction[count - decimal->integer_size]) >= '5') {
+        significand++;
+    }
+
+    long long exponent = decimal->exponent - (long long)count;
+    long double scaled = (long double)significand;// extended precision where available, rounded once to double
+    if (exponent >= 0) {
+        scaled *= oijson_internal_power_of_ten(exponent > 800 ? 800 : (unsigned int)exponent);
+    }
+    else if (exponent >= -308) {
+        scaled /= oijson_internal_power_of_ten((unsigned int)-exponent);
+    }
+    else {// 10^-exponent may not fit, divide in two steps to reach subnormals
+        scaled /= oijson_internal_power_of_ten(308);
+        scaled /= oijson_internal_power_of_ten(exponent < -800 ? 800 : (unsigned int)(-exponent - 308));
+    }
+    double out = (double)scaled;
+    return decimal->negative ? -out : out;
+}
+
+static int oijson_internal_number_fraction(const oijson_internal_number* number, double* out) {
+    unsigned long long fraction = 0;
+    const char* end = oijson_internal_parse_ull(number->fraction, number->fraction_size, &fraction);
+    if (!end) {
+        return 0;
+    }
+
+    double fraction_d = number->integer[0] == '-' ? -(double)fraction : (double)fraction;
+    for (const char* ptr = number->fraction; ptr != end; ptr++) {
+        fraction_d /= 10.0;
+    }
+    *out = fraction_d;
+    return 1;
+}
+
+static int oijson_internal_number_to_double(const oijson_internal_number* number, double* out) {
+    oijson_internal_decimal decimal;
+    oijson_internal_number_decimal(number, &decimal);
+    *out = oijson_internal_decimal_to_double(&decimal);
+    return 1;
+}
+
+// The integer part is rounded by the fraction first, then scaled by the exponent, dropping digits divided away.
+// Every step is checked against the range of a long long, then the result against the range of a long.
+static int oijson_internal_number_to_long(const oijson_internal_number* number, long* out) {
+    int negative = number->integer[0] == '-';
+    const char* digits = number->integer + negative;
+    unsigned int digit_count = 0;
+    while (digit_count < number->integer_size - (unsigned int)negative && oijson_internal_is_digit(digits[digit_count])) {
+        digit_count++;
+    }
+    unsigned long long limit = negative ? 9223372036854775808ULL : 9223372036854775807ULL;
+    unsigned long long magnitude = 0;
+    int fits = oijson_internal_digits_fit(digits, digit_count, negative ? "9223372036854775808" : "9223372036854775807", 19);
+    if (fits) {
+        oijson_internal_parse_ull(digits, digit_count, &magnitude);
+    }
+    if (fits && number->fraction) {
+        double fraction_d;
+        if (!oijson_internal_number_fraction(number, &fraction_d)) {
+            return 0;
+        }
+        if (fraction_d < -0.5 || fraction_d > 0.5) {// away from zero
+            fits = magnitude < limit;
+            magnitude++;
+        }
+    }
+    if (fits && number->exponent && magnitude) {
+        const char* exponent_digits = number->exponent;
+        int exponent_negative = *exponent_digits == '-';
+        if (exponent_negative || *exponent_digits == '+') {
+            exponent_digits++;
+        }
+        unsigned int exponent_size = 0;
+        while (exponent_size < number->exponent_size - (unsigned int)(exponent_digits - number->exponent) && oijson_internal_is_digit(exponent_digits[exponent_size])) {
+            exponent_size++;
+        }
+        while (exponent_size > 1 && exponent_digits[0] == '0') {
+            exponent_digits++;
+            exponent_size--;
+        }
+        unsigned long long exponent = 20;// 10^20 scales every long to 0 or out of range, so longer exponents are not read
+        if (exponent_size <= 2) {
+            oijson_internal_parse_ull(exponent_digits, exponent_size, &exponent);
+        }
+        for (; exponent && magnitude && fits; exponent--) {
+            if (exponent_negative) {
+                magnitude /= 10;
+            }
+            else if (magnitude > limit / 10) {
+                fits = 0;
+            }
+            else {
+                magnitude *= 10;
+            }
+        }
+    }
+
+    long long integer = negative ? (long long)(0 - magnitude) : (long long)magnitude;// two's complement, so -2^63 wraps to itself
+    if (!fits || (long long)(long)integer != integer) {
+        oijson_internal_error_set("number out of range");
+        return 0;
+    }
+    *out = (long)integer;
+    return 1;
+}
+
+int oijson_value_as_double(oijson value, double* out) {
+    if (value.type != oijson_type_number) {
+        oijson_internal_error_set("value is not a number");
+        return 0;
+    }
+
+    oijson_internal_number number;
+    if (!oijson_internal_value_number(value, &number)) {
+        return 0;
+    }
+    return !out || oijson_internal_number_to_double(&number, out);
+}
+
+int oijson_value_as_float(oijson value, float* out) {
+    double d;
+    if (oijson_value_as_double(value, &d)) {
+        if (out) {
+            *out = (float)d;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+int oijson_value_as_long(oijson value, long* out) {
+    if (value.type != oijson_type_number) {
+        oijson_internal_error_set("value is not a number");
+        return 0;
+    }
+
+    oijson_internal_number number;
+    if (!oijson_internal_value_number(value, &number)) {
+        return 0;
+    }
+    return !out || oijson_internal_number_to_long(&number, out);
+}
+
+int oijson_value_as_int(oijson value, int* out) {
+    long l;
+    if (!oijson_value_as_long(value, &l)) {
+        return 0;
+    }
+    if ((long)(int)l != l) {
+        oijson_internal_error_set("number out of range");
+        return 0;
+    }
+    if (out) {
+        *out = (int)l;
+    }
+    return 1;
+}
+
+int oijson_value_as_number(oijson value, oijson_number* out) {
+    if (value.type != oijson_type_number) {
+        oijson_internal_error_set("value is not a number");
+        return 0;
+    }
+    if (!out) {
+        oijson_internal_error_set("invalid number");
+        return 0;
+    }
+
+    oijson_internal_number number;
+    if (!oijson_internal_value_number(value, &number)) {
+        return 0;
+    }
+
+    int negative = number.integer[0] == '-';
+    const char* digits = number.integer + negative;
+    unsigned int digit_count = 0;
+    while (digit_count < number.integer_size - (unsigned int)negative && oijson_internal_is_digit(digits[digit_count])) {
+        digit_count++;
+    }
+
+    if (!number.fraction && !number.exponent) {
+        if (oijson_internal_digits_fit(digits, digit_count, negative ? "9223372036854775808" : "9223372036854775807", 19)) {
+            unsigned long long magnitude = 0;
+            oijson_internal_parse_ull(digits, digit_count, &magnitude);
+            out->number_class = oijson_number_class_integer;
+            out->integer = negative ? (long long)(0 - magnitude) : (long long)magnitude;// two's complement, so -2^63 wraps to itself
+            out->real = (double)out->integer;
+            return 1;
+        }
+    }
+
+    oijson_internal_decimal decimal;
+    oijson_internal_number_decimal(&number, &decimal);
+    out->real = oijson_internal_decimal_to_double(&decimal);
+    out->number_class = number.fraction || number.exponent ? oijson_number_class_real : oijson_number_class_big;
+    if (decimal.integer_size + decimal.fraction_size > 17) {// more significant digits than a double holds
+        out->number_class = oijson_number_class_big;
+    }
+    if (out->real - out->real != 0.0 || (out->real == 0.0 && decimal.integer_size + decimal.fraction_size)) {// out of the double range
+        out->number_class = oijson_number_class_big;
+    }
+
+    out->integer = 0;
+    if (out->real < 9223372036854775808.0 && out->real >= -9223372036854775808.0) {// rounded half away from zero
+        out->integer = (long long)(out->real < 0.0 ? out->real - 0.5 : out->real + 0.5);
+    }
+    return 1;
+}
+
+int oijson_number_as_double(const oijson_number* number, double* out) {
+    if (!number || number->number_class == oijson_number_class_invalid) {
+        oijson_internal_error_set("invalid number");
+        return 0;
+    }
+    if (out) {
+        *out = number->real;
+    }
+    return 1;
+}
+
+int oijson_number_as_float(const oijson_number* number, float* out) {
+    double d;
+    if (!oijson_number_as_double(number, &d)) {
+        return 0;
+    }
+    if (out) {
+        *out = (float)d;
+    }
+    return 1;
+}
+
+int oijson_number_as_long(const oijson_number* number, long* out) {
+    if (!number || number->number_class == oijson_number_class_invalid) {
+        oijson_internal_error_set("invalid number");
+        return 0;
+    }
+    if (!(number->real < 9223372036854775808.0 && number->real >= -9223372036854775808.0) || (long long)(long)number->integer != number->integer) {
+        oijson_internal_error_set("number out of range");
+        return 0;
+    }
+    if (out) {
+        *out = (long)number->integer;
+    }
+    return 1;
+}
+
+int oijson_number_as_int(const oijson_number* number, int* out) {
+    long l;
+    if (!oijson_number_as_long(number, &l)) {
+        return 0;
+    }
+    if ((long)(int)l != l) {
+        oijson_internal_error_set("number out of range");
+        return 0;
+    }
+    if (out) {
+        *out = (int)l;
+    }
+    return 1;
+}
+
+static unsigned long long oijson_internal_hash_finish(unsigned long long hash) {// splitmix64 finalizer, every input bit affects every output bit
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
+
+static int oijson_internal_value_decimal(oijson value, oijson_internal_decimal* out) {
+    oijson_internal_number number;
+    if (!oijson_internal_value_number(value, &number)) {
+        return 0;
+    }
+    oijson_internal_number_decimal(&number, out);
+    return 1;
+}
+
+static int oijson_internal_decimal_equal(const oijson_internal_decimal* a, const oijson_internal_decimal* b) {
+    unsigned int size = a->integer_size + a->fraction_size;
+    if (a->negative != b->negative || a->exponent != b->exponent || size != b->integer_size + b->fraction_size ||
+        a->long_exponent_size != b->long_exponent_size || a->long_exponent_negative != b->long_exponent_negative) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < a->long_exponent_size; i++) {
+        if (a->long_exponent[i] != b->long_exponent[i]) {
+            return 0;
+        }
+    }
+    for (unsigned int i = 0; i < size; i++) {
+        char digit_a = i < a->integer_size ? a->integer[i] : a->fraction[i - a->integer_size];
+        char digit_b = i < b->integer_size ? b->integer[i] : b->fraction[i - b->integer_size];
+        if (digit_a != digit_b) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int oijson_internal_hash(oijson value, unsigned long long* out) {
+    unsigned long long hash = 0;
+    switch (value.type) {
+        case oijson_type_string:
+            if (!oijson_internal_string_hash(value, &hash)) {
+                return 0;
+            }
+            break;
+        case oijson_type_number:
+        {
+            oijson_internal_decimal decimal;
+            if (!oijson_internal_value_decimal(value, &decimal)) {
+                return 0;
+            }
+            hash = oijson_internal_fnv1a(OIJSON_FNV1A_BASIS, decimal.integer, decimal.integer_size);
+            hash = oijson_internal_fnv1a(hash, decimal.fraction, decimal.fraction_size);
+            hash = oijson_internal_fnv1a(hash, decimal.long_exponent, decimal.long_exponent_size);
+            hash = oijson_internal_hash_finish(hash + (unsigned long long)decimal.exponent) + (unsigned long long)(decimal.negative + 2 * decimal.long_exponent_negative);
+            break;
+        }
+        case oijson_type_array:
+            for (oijson_iterator iterator = oijson_iterator_create(value); iterator.type == oijson_iterator_type_array; oijson_iterator_advance(&iterator)) {
+                unsigned long long element;
+                if (!oijson_internal_hash(iterator.value, &element)) {
+                    return 0;
+                }
+                hash = oijson_internal_hash_finish(hash + element);// depends on the order of elements
+            }
+            break;
+        case oijson_type_object:
+            for (oijson_iterator iterator = oijson_iterator_create(value); iterator.type == oijson_iterator_type_object; oijson_iterator_advance(&iterator)) {
+                unsigned long long name;
+                unsigned long long member;
+                if (!oijson_internal_string_hash(iterator.name, &name) || !oijson_internal_hash(iterator.value, &member)) {
+                    return 0;
+                }
+                hash += oijson_internal_hash_finish(oijson_internal_hash_finish(name) + member);// a sum does not depend on the order of members, and counts repeated ones
+            }
+            break;
+        case oijson_type_true:
+        case oijson_type_false:
+        case oijson_type_null:
+            break;
+        default:
+            oijson_internal_error_set("invalid value");
+            return 0;
+    }
+    *out = oijson_internal_hash_finish(hash + (unsigned long long)value.type * 0x9e3779b97f4a7c15ULL);
+    return 1;
+}
+
+int oijson_hash(oijson value, unsigned long long* out) {
+    unsigned long long hash;
+    if (!oijson_internal_hash(value, &hash)) {
+        return 0;
+    }
+    if (out) {
+        *out = hash;
+    }
+    return 1;
+}
+
+#define OIJSON_EQUAL_SLOTS 64// hash slots for the members of one object compared by oijson_equal, half of them are used so probes stay short
+
+static int oijson_internal_equal(oijson a, oijson b);
+
+static unsigned int oijson_internal_member_count(oijson object, oijson name, oijson value) {// members of object with this name and an equal value
+    unsigned int count = 0;
+    for (oijson_iterator iterator = oijson_iterator_create(object); iterator.type == oijson_iterator_type_object; oijson_iterator_advance(&iterator)) {
+        if (oijson_internal_name_equals_name(iterator.name, name) && oijson_internal_equal(iterator.value, value)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static int oijson_internal_equal(oijson a, oijson b) {
+    if (a.type != b.type) {
+        return 0;
+    }
+    if (a.size == b.size) {// the same text has the same meaning
+        unsigned int i = 0;
+        while (i < a.size && a.buffer[i] == b.buffer[i]) {
+            i++;
+        }
+        if (i == a.size) {
+            return 1;
+        }
+    }
+
+    switch (a.type) {
+        case oijson_type_string:
+            return oijson_internal_name_equals_name(a, b);
+        case oijson_type_number:
+        {
+            oijson_internal_decimal decimal_a;
+            oijson_internal_decimal decimal_b;
+            return oijson_internal_value_decimal(a, &decimal_a) && oijson_internal_value_decimal(b, &decimal_b) &&
+                oijson_internal_decimal_equal(&decimal_a, &decimal_b);
+        }
+        case oijson_type_array:
+        {
+            oijson_iterator iterator_a = oijson_iterator_create(a);
+            oijson_iterator iterator_b = oijson_iterator_create(b);
+            while (iterator_a.type == oijson_iterator_type_array && iterator_b.type == oijson_iterator_type_array) {
+                if (!oijson_internal_equal(iterator_a.value, iterator_b.value)) {
+                    return 0;
+                }
+                oijson_iterator_advance(&iterator_a);
+                oijson_iterator_advance(&iterator_b);
+            }
+            return iterator_a.type == iterator_b.type;
+        }
+        case oijson_type_object:
+        {
+            unsigned int count = oijson_object_count(a);
+            if (count != oijson_object_count(b)) {
+                return 0;
+            }
+            if (count > OIJSON_EQUAL_SLOTS / 2 || a.size > 0x7FFFFFFFu) {
+                for (oijson_iterator iterator_a = oijson_iterator_create(a); iterator_a.type == oijson_iterator_type_object; oijson_iterator_advance(&iterator_a)) {
+                    // each name/value pair must appear as often in b as in a, so repeated names compare the same both ways
+                    unsigned int count_a = oijson_internal_member_count(a, iterator_a.name, iterator_a.value);
+                    if (!count_a || count_a != oijson_internal_member_count(b, iterator_a.name, iterator_a.value)) {
+                        return 0;
+                    }
+                }
+                return 1;
+            }
+
+            oijson_keyset_slot slots[OIJSON_EQUAL_SLOTS];// ids are offsets of the names of a from its buffer, repeated names get a slot each
+            for (unsigned int i = 0; i < OIJSON_EQUAL_SLOTS; i++) {
+                slots[i].id = -1;
+            }
+            for (oijson_iterator iterator_a = oijson_iterator_create(a); iterator_a.type == oijson_iterator_type_object; oijson_iterator_advance(&iterator_a)) {
+                unsigned long long name_hash;
+                if (!oijson_internal_string_hash(iterator_a.name, &name_hash)) {
+                    return 0;
+                }
+                unsigned int slot = (unsigned int)name_hash & (OIJSON_EQUAL_SLOTS - 1);
+                while (slots[slot].id >= 0) {
+                    slot = (slot + 1) & (OIJSON_EQUAL_SLOTS - 1);
+                }
+                slots[slot].hash = (unsigned int)name_hash;
+                slots[slot].id = (int)(iterator_a.name.buffer - a.buffer);
+            }
+
+            unsigned long long matched = 0;// slots already paired with a member of b
+            for (oijson_iterator iterator_b = oijson_iterator_create(b); iterator_b.type == oijson_iterator_type_object; oijson_iterator_advance(&iterator_b)) {
+                unsigned long long name_hash;
+                if (!oijson_internal_string_hash(iterator_b.name, &name_hash)) {
+                    return 0;
+                }
+                unsigned int slot = (unsigned int)name_hash & (OIJSON_EQUAL_SLOTS - 1);
+                for (;; slot = (slot + 1) & (OIJSON_EQUAL_SLOTS - 1)) {// equal members share a probe, so taking the first unpaired one pairs them all
+                    if (slots[slot].id < 0) {
+                        return 0;
+                    }
+                    if (!((matched >> slot) & 1) && slots[slot].hash == (unsigned int)name_hash) {
+                        oijson_iterator member = oijson_internal_member_at(a, (unsigned int)slots[slot].id);
+                        if (oijson_internal_name_equals_name(member.name, iterator_b.name) && oijson_internal_equal(member.value, iterator_b.value)) {
+                            matched |= 1ULL << slot;
+                            break;
+                        }
+                    }
+                }
+            }
+            return 1;
+        }
+        default:
+            return 1;
+    }
+}
+
+int oijson_equal(oijson a, oijson b) {
+    if (a.type == oijson_type_invalid || b.type == oijson_type_invalid) {
+        oijson_internal_error_set("invalid value");
+        return 0;
+    }
+    unsigned long long hash_a;
+    unsigned long long hash_b;
+    if (a.type != b.type || !oijson_internal_hash(a, &hash_a) || !oijson_internal_hash(b, &hash_b) || hash_a != hash_b) {// most unequal values stop here in O(N)
+        return 0;
+    }
+    return oijson_internal_equal(a, b);
+}
+
+static int oijson_internal_store_double(const oijson_internal_number* number, void* out, unsigned int index) {
+    return oijson_internal_number_to_double(number, (double*)out + index);
+}
+
+static int oijson_internal_store_float(const oijson_internal_number* number, void* out, unsigned int index) {
+    double d;
+    if (!oijson_internal_number_to_double(number, &d)) {
+        return 0;
+    }
+    ((float*)out)[index] = (float)d;
+    return 1;
+}
+
+static int oijson_internal_store_long(const oijson_internal_number* number, void* out, unsigned int index) {
+    return oijson_internal_number_to_long(number, (long*)out + index);
+}
+
+static int oijson_internal_store_int(const oijson_internal_number* number, void* out, unsigned int index) {
+    long l;
+    if (!oijson_internal_number_to_long(number, &l)) {
+        return 0;
+    }
+    if ((long)(int)l != l) {
+        oijson_internal_error_set("number out of range");
+        return 0;
+    }
+    ((int*)out)[index] = (int)l;
+    return 1;
+}
+
+static int oijson_internal_array_as_numbers(oijson array, void* out, unsigned int out_size, unsigned int* out_count, int (*store)(const oijson_internal_number*, void*, unsigned int)) {
+    if (out_count) {
+        *out_count = 0;
+    }
+    if (array.type != oijson_type_array) {
+        oijson_internal_error_set("not an array");
+        return 0;
+    }
+
+    unsigned int size = array.size;
+    const char* itr = oijson_internal_consume_utf8(array.buffer, &size);// skip '['
+    itr = oijson_internal_consume_whitespace(itr, &size);
+    if (itr && *itr == ']') {
+        return 1;
     }
-    oijson_internal_error_set("name/value pair not found");
-    return OIJSON_INVALID;
-}
 
-oijson oijson_object_value_by_index(oijson object, unsigned int index) {
-    if (object.type != oijson_type_object) {
-        oijson_internal_error_set("not an object");
-        return OIJSON_INVALID;
+    unsigned int count = 0;
+    while (itr) {// each element is decoded right where it is consumed
+        oijson_internal_number number;
+        itr = oijson_internal_consume_number_parts(itr, &size, &number);
+        if (!itr) {
+            oijson_internal_error_set("value is not a number");
+            break;
+        }
+        if (count >= out_size) {
+            oijson_internal_error_set("buffer too small");
+            break;
+        }
+        if (!store(&number, out, count)) {
+            break;
+        }
+        count++;
+
+        itr = oijson_internal_consume_whitespace(itr, &size);
+        if (!itr) {
+            break;
+        }
+        if (*itr == ']') {
+            if (out_count) {
+                *out_count = count;
+            }
+            return 1;
+        }
+        if (*itr != ',') {
+            oijson_internal_error_set("',' or ']' expected");
+            break;
+        }
+        itr++;// step over ','
+        size--;
     }
 
-    oijson_iterator iterator = oijson_iterator_create(object);
-    while (iterator.type != oijson_iterator_type_invalid && index--) {
-        oijson_iterator_advance(&iterator);
+    if (out_count) {
+        *out_count = count;
     }
-    if (iterator.type == oijson_iterator_type_invalid) {
-        oijson_internal_error_set("index out of range");
+    return 0;
+}
+
+int oijson_array_as_doubles(oijson array, double* out, unsigned int out_size, unsigned int* out_count) {
+    return oijson_internal_array_as_numbers(array, out, out_size, out_count, oijson_internal_store_double);
+}
+
+int oijson_array_as_floats(oijson array, float* out, unsigned int out_size, unsigned int* out_count) {
+    return oijson_internal_array_as_numbers(array, out, out_size, out_count, oijson_internal_store_float);
+}
+
+int oijson_array_as_longs(oijson array, long* out, unsigned int out_size, unsigned int* out_count) {
+    return oijson_internal_array_as_numbers(array, out, out_size, out_count, oijson_internal_store_long);
+}
+
+int oijson_array_as_ints(oijson array, int* out, unsigned int out_size, unsigned int* out_count) {
+    return oijson_internal_array_as_numbers(array, out, out_size, out_count, oijson_internal_store_int);
+}
+
+static int oijson_internal_value_as_bool(oijson value, int* out) {
+    if (value.type != oijson_type_true && value.type != oijson_type_false) {
+        oijson_internal_error_set("value is not a boolean");
+        return 0;
     }
-    return iterator.value;
+    *out = value.type == oijson_type_true;
+    return 1;
 }
 
-oijson oijson_object_name_by_index(oijson object, unsigned int index) {
-    if (object.type != oijson_type_object) {
-        oijson_internal_error_set("not an object");
-        return OIJSON_INVALID;
+static int oijson_internal_column_store(oijson_column* column, unsigned int row, oijson value) {
+    switch (column->type) {
+        case oijson_field_type_value:
+            ((oijson*)column->data)[row] = value;
+            return 1;
+        case oijson_field_type_double:
+            return oijson_value_as_double(value, (double*)column->data + row);
+        case oijson_field_type_float:
+            return oijson_value_as_float(value, (float*)column->data + row);
+        case oijson_field_type_long:
+            return oijson_value_as_long(value, (long*)column->data + row);
+        case oijson_field_type_int:
+            return oijson_value_as_int(value, (int*)column->data + row);
+        case oijson_field_type_bool:
+            return oijson_internal_value_as_bool(value, (int*)column->data + row);
+        default:// strings and objects have no fixed size
+            break;
     }
+    oijson_internal_error_set("invalid field type");
+    return 0;
+}
 
-    oijson_iterator iterator = oijson_iterator_create(object);
-    while (iterator.type != oijson_iterator_type_invalid && index--) {
-        oijson_iterator_advance(&iterator);
+static void oijson_internal_column_clear(oijson_column* column, unsigned int row) {
+    switch (column->type) {
+        case oijson_field_type_value:
+            ((oijson*)column->data)[row] = OIJSON_INVALID;
+            break;
+        case oijson_field_type_double:
+            ((double*)column->data)[row] = 0.0;
+            break;
+        case oijson_field_type_float:
+            ((float*)column->data)[row] = 0.0f;
+            break;
+        case oijson_field_type_long:
+            ((long*)column->data)[row] = 0;
+            break;
+        case oijson_field_type_int:
+        case oijson_field_type_bool:
+            ((int*)column->data)[row] = 0;
+            break;
+        default:
+            break;
     }
-    if (iterator.type == oijson_iterator_type_invalid) {
-        oijson_internal_error_set("index out of range");
+    if (column->present) {
+        column->present[row / 8] &= (unsigned char)~(1u << (row % 8));
     }
-    return iterator.name;
 }
 
-
-unsigned int oijson_array_count(oijson array) {
+int oijson_array_extract_columns(oijson array, oijson_column* columns, unsigned int column_count, unsigned int row_capacity, unsigned int* out_rows) {
+    if (out_rows) {
+        *out_rows = 0;
+    }
     if (array.type != oijson_type_array) {
         oijson_internal_error_set("not an array");
         return 0;
     }
 
-    unsigned int count = 0;
-    oijson_iterator iterator = oijson_iterator_create(array);
-    while (iterator.type != oijson_iterator_type_invalid) {
-        count++;
-        oijson_iterator_advance(&iterator);
+    unsigned int row = 0;
+    oijson_iterator row_iterator = oijson_iterator_create(array);
+    while (row_iterator.type != oijson_iterator_type_invalid) {
+        if (row_iterator.value.type != oijson_type_object) {
+            oijson_internal_error_set("not an object");
+            break;
+        }
+        if (row >= row_capacity) {
+            oijson_internal_error_set("buffer too small");
+            break;
+        }
+
+        for (unsigned int i = 0; i < column_count; i++) {// missing and null fields are left cleared
+            oijson_internal_column_clear(&columns[i], row);
+        }
+
+        int failed = 0;
+        oijson_iterator field_iterator = oijson_iterator_create(row_iterator.value);
+        while (!failed && field_iterator.type != oijson_iterator_type_invalid) {
+            if (field_iterator.value.type != oijson_type_null) {
+                for (unsigned int i = 0; i < column_count; i++) {
+                    if (oijson_internal_name_equals(field_iterator.name, columns[i].name)) {
+                        if (!oijson_internal_column_store(&columns[i], row, field_iterator.value)) {
+                            failed = 1;
+                            break;
+                        }
+                        if (columns[i].present) {
+                            columns[i].present[row / 8] |= (unsigned char)(1u << (row % 8));
+                        }
+                        break;
+                    }
+                }
+            }
+            oijson_iterator_advance(&field_iterator);
+        }
+        if (failed) {
+            break;
+        }
+
+        row++;
+        oijson_iterator_advance(&row_iterator);
     }
-    return count;
-}
 
-oijson oijson_array_value_by_index(oijson array, unsigned int index) {
-    if (array.type != oijson_type_array) {
-        oijson_internal_error_set("not an array");
-        return OIJSON_INVALID;
+    if (out_rows) {
+        *out_rows = row;
     }
+    return row_iterator.type == oijson_iterator_type_invalid;
+}
 
-    oijson_iterator iterator = oijson_iterator_create(array);
-    while (iterator.type != oijson_iterator_type_invalid && index--) {
-        oijson_iterator_advance(&iterator);
+static int oijson_internal_bind_field(const oijson_field* field, char* out, oijson value) {
+    char* target = out + field->offset;
+    int result = 0;
+    switch (field->type) {
+        case oijson_field_type_value:
+            *(oijson*)target = value;
+            return 1;
+        case oijson_field_type_double:
+            result = oijson_value_as_double(value, (double*)target);
+            break;
+        case oijson_field_type_float:
+            result = oijson_value_as_float(value, (float*)target);
+            break;
+        case oijson_field_type_long:
+            result = oijson_value_as_long(value, (long*)target);
+            break;
+        case oijson_field_type_int:
+            result = oijson_value_as_int(value, (int*)target);
+            break;
+        case oijson_field_type_bool:
+            result = oijson_internal_value_as_bool(value, (int*)target);
+            break;
+        case oijson_field_type_string:
+            result = oijson_value_as_string(value, target, field->size);
+            break;
+        case oijson_field_type_object:
+            if (value.type == oijson_type_object) {
+                return oijson_bind(value, field->fields, field->field_count, target);// reports its own fields
+            }
+            break;
     }
-    if (iterator.type == oijson_iterator_type_invalid) {
-        oijson_internal_error_set("index out of range");
+    if (!result) {
+        oijson_internal_error_set_field("invalid field", field->name);
     }
-    return iterator.value;
+    return result;
 }
 
-static int oijson_internal_formatted_value(oijson value, char** out_ptr, unsigned int* out_size_ptr);
+#define OIJSON_BIND_SLOTS 128// hash slots for the field names bound in one pass, half of them are used so probes stay short
 
-static int oijson_internal_formatted_object(oijson object, char** out_ptr, unsigned int* out_size_ptr) {
-    if (!oijson_internal_push_char(out_ptr, out_size_ptr, '{')) {
+// Fields are hashed by name in groups of OIJSON_BIND_SLOTS / 2, and each group reads the members once, so up to 64
+// fields cost O(M + F). Presence is kept as one bit per field of the group, so a later non-null member still counts.
+int oijson_bind(oijson object, const oijson_field* fields, unsigned int field_count, void* out) {
+    if (object.type != oijson_type_object) {
+        oijson_internal_error_set("not an object");
         return 0;
     }
 
-    oijson_iterator iterator = oijson_iterator_create(object);
-    while (iterator.type != oijson_iterator_type_invalid) {
-        if (!oijson_internal_formatted_value(iterator.name, out_ptr, out_size_ptr)) {
-            return 0;
+    for (unsigned int group = 0; group < field_count; group += OIJSON_BIND_SLOTS / 2) {
+        unsigned int group_end = field_count - group > OIJSON_BIND_SLOTS / 2 ? group + OIJSON_BIND_SLOTS / 2 : field_count;
+        oijson_keyset_slot slots[OIJSON_BIND_SLOTS];// ids index fields
+        for (unsigned int i = 0; i < OIJSON_BIND_SLOTS; i++) {
+            slots[i].id = -1;
         }
-
-        if (!oijson_internal_push_char(out_ptr, out_size_ptr, ':')) {
-            return 0;
+        for (unsigned int i = group; i < group_end; i++) {// a repeated name is placed after the first, which is found first
+            unsigned int size = 0;
+            while (fields[i].name[size]) {
+                size++;
+            }
+            unsigned int hash = (unsigned int)oijson_internal_fnv1a(OIJSON_FNV1A_BASIS, fields[i].name, size);
+            unsigned int slot = hash & (OIJSON_BIND_SLOTS - 1);
+            while (slots[slot].id >= 0) {
+                slot = (slot + 1) & (OIJSON_BIND_SLOTS - 1);
+            }
+            slots[slot].hash = hash;
+            slots[slot].id = (int)i;
         }
 
-        if (!oijson_internal_formatted_value(iterator.value, out_ptr, out_size_ptr)) {
-            return 0;
+        unsigned long long found = 0;// one bit for each field of the group
+        oijson_iterator iterator = oijson_iterator_create(object);
+        while (iterator.type != oijson_iterator_type_invalid) {
+            unsigned long long name_hash;
+            if (iterator.value.type != oijson_type_null && oijson_internal_string_hash(iterator.name, &name_hash)) {// null is treated as missing
+                unsigned int hash = (unsigned int)name_hash;
+                for (unsigned int slot = hash & (OIJSON_BIND_SLOTS - 1); slots[slot].id >= 0; slot = (slot + 1) & (OIJSON_BIND_SLOTS - 1)) {
+                    const oijson_field* field = &fields[slots[slot].id];
+                    if (slots[slot].hash == hash && oijson_internal_name_equals(iterator.name, field->name)) {
+                        if (!oijson_internal_bind_field(field, (char*)out, iterator.value)) {
+                            return 0;
+                        }
+                        found |= 1ULL << ((unsigned int)slots[slot].id - group);
+                        break;
+                    }
+                }
+            }
+            oijson_iterator_advance(&iterator);
         }
 
-        oijson_iterator_advance(&iterator);
-        if (iterator.type != oijson_iterator_type_invalid) {
-            if (!oijson_internal_push_char(out_ptr, out_size_ptr, ',')) {
+        for (unsigned int i = group; i < group_end; i++) {
+            if (!fields[i].optional && !((found >> (i - group)) & 1)) {
+                oijson_internal_error_set_field("missing field", fields[i].name);
                 return 0;
             }
         }
     }
+    return 1;
+}
 
-    return oijson_internal_push_char(out_ptr, out_size_ptr, '}');
+static int oijson_internal_push_bytes(char** out_ptr, unsigned int* out_size_ptr, const char* data, unsigned int size) {
+    if (size > *out_size_ptr) {
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+    for (unsigned int i = 0; i < size; i++) {
+        (*out_ptr)[i] = data[i];
+    }
+    *out_ptr += size;
+    *out_size_ptr -= size;
+    return 1;
 }
 
-static int oijson_internal_formatted_array(oijson array, char** out_ptr, unsigned int* out_size_ptr) {
-    if (!oijson_internal_push_char(out_ptr, out_size_ptr, '[')) {
+static unsigned int oijson_internal_store_big_endian(char* out, unsigned long long value, unsigned int byte_count) {
+    for (unsigned int i = 0; i < byte_count; i++) {
+        out[i] = (char)(unsigned char)(value >> ((byte_count - 1 - i) * 8));
+    }
+    return byte_count;
+}
+
+// Binary formats, see RFC 8949 for CBOR and https://github.com/msgpack/msgpack/blob/master/spec.md for MessagePack
+typedef enum oijson_internal_binary_format_e {
+    oijson_internal_binary_format_cbor,
+    oijson_internal_binary_format_msgpack,
+} oijson_internal_binary_format;
+
+static unsigned int oijson_internal_cbor_head(char* head, unsigned char major, unsigned long long n) {// major type and argument
+    unsigned char initial = (unsigned char)(major << 5);
+    if (n < 24) {
+        head[0] = (char)(initial | n);
+        return 1;
+    }
+    unsigned int byte_count = n <= 0xFF ? 1 : n <= 0xFFFF ? 2 : n <= 0xFFFFFFFF ? 4 : 8;
+    head[0] = (char)(initial | (byte_count == 1 ? 24 : byte_count == 2 ? 25 : byte_count == 4 ? 26 : 27));
+    return 1 + oijson_internal_store_big_endian(head + 1, n, byte_count);
+}
+
+static unsigned int oijson_internal_binary_count_head(oijson_internal_binary_format format, oijson_type type, unsigned int count, char* head) {// header of a string, array or object
+    if (format == oijson_internal_binary_format_cbor) {
+        return oijson_internal_cbor_head(head, type == oijson_type_string ? 3 : type == oijson_type_array ? 4 : 5, count);
+    }
+
+    unsigned int fix_limit = type == oijson_type_string ? 32 : 16;
+    unsigned char fix_prefix = type == oijson_type_string ? 0xa0 : type == oijson_type_array ? 0x90 : 0x80;
+    if (count < fix_limit) {
+        head[0] = (char)(fix_prefix | count);
+        return 1;
+    }
+    if (type == oijson_type_string && count <= 0xFF) {
+        head[0] = (char)0xd9;
+        return 1 + oijson_internal_store_big_endian(head + 1, count, 1);
+    }
+    unsigned char prefix = type == oijson_type_string ? 0xda : type == oijson_type_array ? 0xdc : 0xde;// 16 bit count, 32 bit count follows
+    if (count <= 0xFFFF) {
+        head[0] = (char)prefix;
+        return 1 + oijson_internal_store_big_endian(head + 1, count, 2);
+    }
+    head[0] = (char)(prefix + 1);
+    return 1 + oijson_internal_store_big_endian(head + 1, count, 4);
+}
+
+static unsigned int oijson_internal_binary_integer(oijson_internal_binary_format format, int negative, unsigned long long magnitude, char* head) {// -magnitude when negative, up to 2^63
+    if (format == oijson_internal_binary_format_cbor) {
+        return negative ? oijson_internal_cbor_head(head, 1, magnitude - 1) : oijson_internal_cbor_head(head, 0, magnitude);
+    }
+
+    if (negative ? magnitude <= 32 : magnitude < 128) {// positive and negative fixint
+        head[0] = (char)(unsigned char)((negative ? 0 - magnitude : magnitude) & 0xFF);
+        return 1;
+    }
+    unsigned int byte_count;
+    unsigned char prefix;
+    if (!negative) {// uint 8 to 64
+        byte_count = magnitude <= 0xFF ? 1 : magnitude <= 0xFFFF ? 2 : magnitude <= 0xFFFFFFFF ? 4 : 8;
+        prefix = 0xcc;
+    }
+    else {
+        byte_count = magnitude <= 0x80 ? 1 : magnitude <= 0x8000 ? 2 : magnitude <= 0x80000000ULL ? 4 : 8;
+        prefix = 0xd0;
+    }
+    head[0] = (char)(prefix + (byte_count == 1 ? 0 : byte_count == 2 ? 1 : byte_count == 4 ? 2 : 3));
+    return 1 + oijson_internal_store_big_endian(head + 1, negative ? 0 - magnitude : magnitude, byte_count);// two's complement
+}
+
+static unsigned int oijson_internal_binary_float(oijson_internal_binary_format format, double value, char* head) {// single precision when exact
+    int cbor = format == oijson_internal_binary_format_cbor;
+    if (value >= -3.4028234663852886e38 && value <= 3.4028234663852886e38) {// narrowing outside the float range is undefined
+        float single = (float)value;
+        if ((double)single == value) {
+            union { float f; unsigned int u; } bits;
+            bits.f = single;
+            head[0] = (char)(cbor ? 0xfa : 0xca);
+            return 1 + oijson_internal_store_big_endian(head + 1, bits.u, 4);
+        }
+    }
+    union { double d; unsigned long long u; } bits;
+    bits.d = value;
+    head[0] = (char)(cbor ? 0xfb : 0xcb);
+    return 1 + oijson_internal_store_big_endian(head + 1, bits.u, 8);
+}
+
+static int oijson_internal_binary_number(oijson_internal_binary_format format, oijson value, char** out_ptr, unsigned int* out_size_ptr) {
+    oijson_internal_number number;
+    if (!oijson_internal_value_number(value, &number)) {
         return 0;
     }
 
-    oijson_iterator iterator = oijson_iterator_create(array);
-    while (iterator.type != oijson_iterator_type_invalid) {
-        if (!oijson_internal_formatted_value(iterator.value, out_ptr, out_size_ptr)) {
+    char head[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    unsigned int head_size;
+    int negative = number.integer[0] == '-';
+    const char* digits = number.integer + negative;
+    unsigned int digit_count = number.integer_size - (unsigned int)negative;
+    if (!number.fraction && !number.exponent &&
+        oijson_internal_digits_fit(digits, digit_count, negative ? "9223372036854775808" : "18446744073709551615", negative ? 19 : 20)) {// int64 and uint64
+        unsigned long long magnitude = 0;
+        oijson_internal_parse_ull(digits, digit_count, &magnitude);
+        head_size = oijson_internal_binary_integer(format, negative && magnitude, magnitude, head);// -0 is written as 0
+    }
+    else {
+        double d;
+        if (!oijson_internal_number_to_double(&number, &d)) {
             return 0;
         }
-        oijson_iterator_advance(&iterator);
-        if (iterator.type != oijson_iterator_type_invalid) {
-            if (!oijson_internal_push_char(out_ptr, out_size_ptr, ',')) {
-                return 0;
-            }
-        }
+        head_size = oijson_internal_binary_float(format, d, head);
     }
-
-    return oijson_internal_push_char(out_ptr, out_size_ptr, ']');
+    return oijson_internal_push_bytes(out_ptr, out_size_ptr, head, head_size);
 }
 
-static int oijson_internal_formatted_string(oijson value, char** out_ptr, unsigned int* out_size_ptr) {
-    const char* itr = value.buffer;
-    unsigned int size = value.size;
-    do {
-        itr = oijson_internal_parse_char(itr, &size, out_ptr, out_size_ptr);
+static int oijson_internal_binary_string(oijson_internal_binary_format format, oijson value, char** out_ptr, unsigned int* out_size_ptr) {
+    char head[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    unsigned int raw_size = value.size - 2;
+    unsigned int rest = value.size - 1;
+    const char* special = oijson_internal_find_string_special(value.buffer + 1, &rest);
+    if (rest && *special == '\"') {// no escape sequences, copy as is
+        unsigned int head_size = oijson_internal_binary_count_head(format, oijson_type_string, raw_size, head);
+        return oijson_internal_push_bytes(out_ptr, out_size_ptr, head, head_size)
+            && oijson_internal_push_bytes(out_ptr, out_size_ptr, value.buffer + 1, raw_size);
+    }
+
+    // decoded strings are never longer than raw ones, so decode after room for the largest header, then move the bytes back
+    unsigned int reserved = oijson_internal_binary_count_head(format, oijson_type_string, raw_size, head);
+    if (reserved > *out_size_ptr) {
+        oijson_internal_error_set("buffer too small");
+        return 0;
+    }
+    char* decoded = *out_ptr + reserved;
+    char* decoded_end = decoded;
+    unsigned int decoded_size = *out_size_ptr - reserved;
+    const char* itr = value.buffer + 1;
+    unsigned int size = raw_size;
+    while (size) {
+        itr = oijson_internal_parse_char(itr, &size, &decoded_end, &decoded_size);
         if (!itr) {
             return 0;
         }
-    } while (*itr != '\"');
-    return oijson_internal_push_char(out_ptr, out_size_ptr, '\"');
+    }
+
+    unsigned int length = (unsigned int)(decoded_end - decoded);
+    unsigned int head_size = oijson_internal_binary_count_head(format, oijson_type_string, length, head);
+    for (unsigned int i = 0; i < head_size; i++) {
+        (*out_ptr)[i] = head[i];
+    }
+    for (unsigned int i = 0; i < length; i++) {
+        (*out_ptr)[head_size + i] = decoded[i];
+    }
+    *out_ptr += head_size + length;
+    *out_size_ptr -= head_size + length;
+    return 1;
 }
 
-static int oijson_internal_formatted_value(oijson value, char** out_ptr, unsigned int* out_size_ptr) {
-    switch (value.type) {
-        case oijson_type_invalid:
+typedef struct oijson_internal_binary_frame_s {// an open object or array
+    unsigned int start;// offset of its header in the output
+    unsigned int count;// elements, or name/value pairs
+} oijson_internal_binary_frame;
+
+static int oijson_internal_binary_close(oijson_internal_binary_format format, oijson_type type, const oijson_internal_binary_frame* frame, char* out, char** out_ptr, unsigned int* out_size_ptr) {
+    char* start = out + frame->start;
+    char head[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    unsigned int head_size = oijson_internal_binary_count_head(format, type, frame->count, head);
+    if (head_size > 1) {// longer containers move their elements to make room for the longer header
+        unsigned int extra = head_size - 1;
+        if (extra > *out_size_ptr) {
+            oijson_internal_error_set("buffer too small");
             return 0;
-        case oijson_type_object:
-            if (!oijson_internal_formatted_object(value, out_ptr, out_size_ptr)) {
+        }
+        for (char* itr = *out_ptr; itr != start + 1; itr--) {
+            itr[extra - 1] = itr[-1];
+        }
+        *out_ptr += extra;
+        *out_size_ptr -= extra;
+    }
+    for (unsigned int i = 0; i < head_size; i++) {
+        start[i] = head[i];
+    }
+    return 1;
+}
+
+// Reads the value once, in order. Containers are counted while writing and their header is patched in when they close,
+// the open ones are kept in a stack of OIJSON_MAX_DEPTH frames instead of recursing.
+static int oijson_internal_binary_value(oijson_internal_binary_format format, oijson value, char* out, char** out_ptr, unsigned int* out_size_ptr) {
+    int cbor = format == oijson_internal_binary_format_cbor;
+    oijson_internal_binary_frame frames[OIJSON_MAX_DEPTH];
+    unsigned char objects[(OIJSON_MAX_DEPTH + 7) / 8];
+    unsigned int depth = 0;
+    int element = 0;// the next value starts an element of the innermost container
+    const char* itr = value.buffer;
+    unsigned int size = value.size;
+    if (value.type == oijson_type_invalid || !itr) {
+        oijson_internal_error_set("value is not valid");
+        return 0;
+    }
+
+    do {
+        while (oijson_internal_is_whitespace(*itr) || *itr == ':') {
+            itr++;
+            size--;
+        }
+        if (*itr == ',') {
+            element = 1;
+            itr++;
+            size--;
+            continue;
+        }
+        if (*itr == '}' || *itr == ']') {
+            depth--;
+            if (!oijson_internal_binary_close(format, oijson_internal_bit_get(objects, depth) ? oijson_type_object : oijson_type_array, &frames[depth], out, out_ptr, out_size_ptr)) {
                 return 0;
             }
-            break;
-        case oijson_type_array:
-            if (!oijson_internal_formatted_array(value, out_ptr, out_size_ptr)) {
-                return 0;
+            element = 0;
+            itr++;
+            size--;
+            continue;
+        }
+
+        if (element) {// a name in objects, a value in arrays
+            frames[depth - 1].count++;
+            element = 0;
+        }
+        const char* start = itr;
+        char head = 0;
+        switch (oijson_internal_type_from_char(*itr)) {
+            case oijson_type_object:
+            case oijson_type_array:
+                if (depth == OIJSON_MAX_DEPTH) {
+                    oijson_internal_error_set("maximum depth exceeded");
+                    return 0;
+                }
+                oijson_internal_bit_set(objects, depth, *itr == '{');
+                frames[depth].start = (unsigned int)(*out_ptr - out);
+                frames[depth].count = 0;
+                depth++;
+                if (!oijson_internal_push_bytes(out_ptr, out_size_ptr, &head, 1)) {// room for the one byte header of short containers
+                    return 0;
+                }
+                element = 1;
+                itr++;
+                size--;
+                continue;
+            case oijson_type_string:
+            {
+                itr++;
+                size--;
+                while (*(itr = oijson_internal_find_string_special(itr, &size)) != '\"') {// an escaped character always follows '\\'
+                    itr += 2;
+                    size -= 2;
+                }
+                itr++;
+                size--;
+                oijson string = { .buffer = start, .size = (unsigned int)(itr - start), .type = oijson_type_string };
+                if (!oijson_internal_binary_string(format, string, out_ptr, out_size_ptr)) {
+                    return 0;
+                }
+                continue;
             }
-            break;
-        case oijson_type_string:
-            return oijson_internal_formatted_string(value, out_ptr, out_size_ptr);
-        default:
-            for (unsigned int i = 0; i < value.size; i++) {
-                if (!oijson_internal_push_char(out_ptr, out_size_ptr, value.buffer[i])) {
+            case oijson_type_number:
+            {
+                oijson_internal_number parts;
+                itr = oijson_internal_consume_number_parts(itr, &size, &parts);
+                oijson number = { .buffer = start, .size = (unsigned int)(itr - start), .type = oijson_type_number };
+                if (!oijson_internal_binary_number(format, number, out_ptr, out_size_ptr)) {
                     return 0;
                 }
+                continue;
             }
-            break;
-    }
+            case oijson_type_true:
+                head = (char)(cbor ? 0xf5 : 0xc3);
+                break;
+            case oijson_type_false:
+                head = (char)(cbor ? 0xf4 : 0xc2);
+                break;
+            case oijson_type_null:
+                head = (char)(cbor ? 0xf6 : 0xc0);
+                break;
+            default:
+                oijson_internal_error_set("value is not valid");
+                return 0;
+        }
+        unsigned int length = *itr == 'f' ? 5 : 4;
+        itr += length;
+        size -= length;
+        if (!oijson_internal_push_bytes(out_ptr, out_size_ptr, &head, 1)) {
+            return 0;
+        }
+    } while (depth);
     return 1;
 }
 
-int oijson_value_formatted(oijson value, char* out, unsigned int out_size) {
-    if (!oijson_internal_pre_truncate(&out, &out_size)) {
+static int oijson_internal_to_binary(oijson_internal_binary_format format, oijson value, unsigned char* out, unsigned int out_size, unsigned int* out_written) {
+    if (!out) {
+        oijson_internal_error_set("invalid buffer");
         return 0;
     }
-
-    if (value.type == oijson_type_invalid) {
-        oijson_internal_error_set("value is not valid");
+    char* out_ptr = (char*)out;
+    unsigned int out_size_left = out_size;
+    if (!oijson_internal_binary_value(format, value, out_ptr, &out_ptr, &out_size_left)) {
         return 0;
     }
-
-    if (!oijson_internal_formatted_value(value, &out, &out_size)) {
-        return 0;
+    if (out_written) {
+        *out_written = out_size - out_size_left;
     }
-    return out_size ? oijson_internal_push_char(&out, &out_size, '\0') : 1;
+    return 1;
 }
 
-int oijson_value_as_string(oijson value, char* out, unsigned int out_size) {
-    if (!oijson_internal_pre_truncate(&out, &out_size)) {
-        return 0;
-    }
-
-    if (value.type != oijson_type_string) {
-        oijson_internal_error_set("value is not a string");
-        return 0;
-    }
+int oijson_to_cbor(oijson value, unsigned char* out, unsigned int out_size, unsigned int* out_written) {
+    return oijson_internal_to_binary(oijson_internal_binary_format_cbor, value, out, out_size, out_written);
+}
 
-    const char* itr = value.buffer + 1;
-    unsigned int size = value.size - 1;
-    do {
-        itr = oijson_internal_parse_char(itr, &size, &out, &out_size);
-        if (!itr) {
-            return 0;
-        }
-    } while (*itr != '\"');
-    return out_size ? oijson_internal_push_char(&out, &out_size, '\0') : 1;
+int oijson_to_msgpack(oijson value, unsigned char* out, unsigned int out_size, unsigned int* out_written) {
+    return oijson_internal_to_binary(oijson_internal_binary_format_msgpack, value, out, out_size, out_written);
 }
 
-static const char* oijson_internal_parse_ull(const char* string, unsigned int string_size, unsigned long long* out) {
-    string = oijson_internal_consume_whitespace(string, &string_size);
-    if(!string || !string_size) {
-        return OIJSON_NULLCHAR;
-    }
+oijson_dom oijson_dom_create(oijson_node* nodes, unsigned int capacity) {
+    oijson_dom dom = {
+        .nodes = nodes,
+        .capacity = nodes ? capacity : 0,
+        .count = 0,
+        .buffer = OIJSON_NULLCHAR,
+        .buffer_size = 0,
+    };
+    return dom;
+}
 
-    const char* ptr = string;
-    const char* start = ptr;//due to previous checks, start is guaranteed to be a number here
+#define OIJSON_DOM_NO_PARENT 0xFFFFFFFFu
+
+// One pass over the validated value. Finished values and open containers are pushed at the front of the nodes, in
+// document order, and an open container keeps the index of its parent in children.first. When a container closes,
+// its children are the nodes above it, which move to a block at the back, so children stay next to each other. The
+// blocks are then moved down after the root. Every node is written at most three times and the value is read once.
+static int oijson_internal_dom_fill(oijson_dom* dom, oijson value) {
+    oijson_node* nodes = dom->nodes;
+    unsigned int top = 0;
+    unsigned int back = dom->capacity;
+    unsigned int open = OIJSON_DOM_NO_PARENT;// innermost open container
+    const char* itr = value.buffer;
+    unsigned int size = value.size;
     do {
-        ptr++;
-        string_size--;
-    } while (string_size && ptr[0] >= '0' && ptr[0] <= '9');
-    const char* end = ptr;
-
-    if(out) {
-        unsigned long long mul = 1;
-        *out = 0;
-        while(ptr != start) {
-            ptr--;
-            *out += mul * (unsigned long long)(*ptr - '0');
-            mul *= 10;
+        while (oijson_internal_is_whitespace(*itr) || *itr == ',' || *itr == ':') {
+            itr++;
+            size--;
         }
-    }
 
-    return end;
-}
+        if (*itr == '}' || *itr == ']') {
+            oijson_node* container = &nodes[open];
+            unsigned int slots = top - open - 1;
+            back -= slots;
+            for (unsigned int i = slots; i; i--) {// the block never starts below the children, so copy from the end
+                nodes[back + i - 1] = nodes[open + i];
+            }
+            unsigned int parent = container->data.children.first;
+            container->data.children.first = back;
+            container->data.children.count = container->type == oijson_type_object ? slots / 2 : slots;
+            top = open + 1;
+            open = parent;
+            itr++;
+            size--;
+            continue;
+        }
 
-static const char* oijson_internal_parse_ll(const char* string, unsigned int string_size, long long* out) {
-    string = oijson_internal_consume_whitespace(string, &string_size);
-    if (!string || !string_size) {
-        return OIJSON_NULLCHAR;
-    }
+        if (top == back) {
+            oijson_internal_error_set("not enough nodes");
+            return 0;
+        }
+        oijson_node* node = &nodes[top++];
+        node->type = oijson_internal_type_from_char(*itr);
+        node->offset = (unsigned int)(itr - dom->buffer);
+        node->data.children.first = 0;
+        node->data.children.count = 0;
+        switch (node->type) {
+            case oijson_type_object:
+            case oijson_type_array:
+                node->data.children.first = open;
+                open = top - 1;
+                itr++;
+                size--;
+                continue;
+            case oijson_type_string:
+                itr++;
+                size--;
+                while (*(itr = oijson_internal_find_string_special(itr, &size)) != '\"') {// an escaped character always follows '\\'
+                    itr += 2;
+                    size -= 2;
+                }
+                itr++;
+                size--;
+                node->data.size = (unsigned int)(itr - (dom->buffer + node->offset));
+                break;
+            case oijson_type_number:
+            {
+                oijson_internal_number parts;
+                itr = oijson_internal_consume_number_parts(itr, &size, &parts);
+                oijson_internal_number_to_double(&parts, &node->data.real);
+                break;
+            }
+            default:// true, false and null
+            {
+                unsigned int length = *itr == 'f' ? 5 : 4;
+                itr += length;
+                size -= length;
+                break;
+            }
+        }
+    } while (open != OIJSON_DOM_NO_PARENT);
 
-    int negative = *string == '-';
-    if (negative) {
-        string++;
-        string_size--;
+    unsigned int shift = back - 1;// top is 1, only the root is left at the front
+    for (unsigned int i = back; i < dom->capacity; i++) {
+        nodes[i - shift] = nodes[i];
     }
-    unsigned long long ull;
-    const char* ptr = oijson_internal_parse_ull(string, string_size, &ull);
-    if(out) {
-        *out = (long long)ull;
-        if (negative) {
-            *out = -(*out);
+    dom->count = dom->capacity - shift;
+    for (unsigned int i = 0; i < dom->count; i++) {
+        if (nodes[i].type == oijson_type_object || nodes[i].type == oijson_type_array) {
+            nodes[i].data.children.first -= shift;
         }
     }
-    return ptr;
+    return 1;
 }
 
-int oijson_value_as_double(oijson value, double* out) {
-    if (value.type != oijson_type_number) {
-        oijson_internal_error_set("value is not a number");
+int oijson_dom_build(oijson_dom* dom, const char* json, unsigned int json_size) {
+    if (!dom) {
+        oijson_internal_error_set("invalid dom");
         return 0;
     }
+    dom->count = 0;// previous nodes are discarded
+    dom->buffer = OIJSON_NULLCHAR;
+    dom->buffer_size = 0;
 
-    long long integer = 0;
-    unsigned long long fraction = 0;
-    unsigned long long fraction_digits = 0;
-    long long exponent = 0;
-
-    unsigned int size = value.size;
-    const char* integer_ptr = OIJSON_NULLCHAR;
-    unsigned int integer_size;
-    const char* fraction_ptr = OIJSON_NULLCHAR;
-    unsigned int fraction_size;
-    const char* exponent_ptr = OIJSON_NULLCHAR;
-    unsigned int exponent_size;
-    const char* ptr = oijson_internal_consume_number_info(value.buffer, &size, &integer_ptr, &integer_size, &fraction_ptr, &fraction_size, &exponent_ptr, &exponent_size);
-    if(!ptr) {
+    oijson root = oijson_parse(json, json_size);
+    if (root.type == oijson_type_invalid) {
+        return 0;
+    }
+    if (!dom->capacity) {
+        oijson_internal_error_set("not enough nodes");
         return 0;
     }
 
-    if (out) {
-        if (!oijson_internal_parse_ll(integer_ptr, integer_size, &integer)) {
-            return 0;
-        }
-        *out = (double)integer;
-        if (fraction_ptr) {
-            if (!oijson_internal_parse_ull(fraction_ptr, fraction_size, &fraction)) {
-                return 0;
-            }
-            const char* ptr2 = fraction_ptr;
-            while (fraction_size && *ptr2 >= '0' && *ptr2 <= '9') {
-                fraction_digits++;
-                ptr2++;
-            }
-
-            double fraction_d = integer_ptr[0] == '-' ? -(double)fraction : (double)fraction;
-            while (fraction_digits) {
-                fraction_d /= 10.0;
-                fraction_digits--;
-            }
-            *out += fraction_d;
-        }
-        if (exponent_ptr) {
-            if (!oijson_internal_parse_ll(exponent_ptr, exponent_size, &exponent)) {
-                return 0;
-            }
+    dom->buffer = json;
+    dom->buffer_size = json_size;
+    if (!oijson_internal_dom_fill(dom, root)) {
+        dom->count = 0;
+        return 0;
+    }
+    return 1;
+}
 
-            while (exponent > 0) {
-                *out *= 10.0;
-                exponent--;
-            }
-            while (exponent < 0) {
-                *out /= 10.0;
-                exponent++;
-            }
-        }
+const oijson_node* oijson_dom_root(const oijson_dom* dom) {
+    if (!dom || !dom->count) {
+        oijson_internal_error_set("empty dom");
+        return 0;
     }
+    return dom->nodes;
+}
 
-    return 1;
+unsigned int oijson_dom_count(const oijson_node* node) {
+    if (!node || (node->type != oijson_type_object && node->type != oijson_type_array)) {
+        oijson_internal_error_set("not an object or array");
+        return 0;
+    }
+    return node->data.children.count;
 }
 
-int oijson_value_as_float(oijson value, float* out) {
-    double d;
-    if (oijson_value_as_double(value, &d)) {
-        if (out) {
-            *out = (float)d;
-        }
-        return 1;
+const oijson_node* oijson_dom_element(const oijson_dom* dom, const oijson_node* array, unsigned int index) {
+    if (!array || array->type != oijson_type_array) {
+        oijson_internal_error_set("not an array");
+        return 0;
     }
-    return 0;
+    if (index >= array->data.children.count) {
+        oijson_internal_error_set("index out of range");
+        return 0;
+    }
+    return &dom->nodes[array->data.children.first + index];
 }
 
-int oijson_value_as_long(oijson value, long* out) {
-    if (value.type != oijson_type_number) {
-        oijson_internal_error_set("value is not a number");
+const oijson_node* oijson_dom_name(const oijson_dom* dom, const oijson_node* object, unsigned int index) {
+    if (!object || object->type != oijson_type_object) {
+        oijson_internal_error_set("not an object");
+        return 0;
+    }
+    if (index >= object->data.children.count) {
+        oijson_internal_error_set("index out of range");
         return 0;
     }
+    return &dom->nodes[object->data.children.first + index * 2];
+}
 
-    long long integer = 0;
-    unsigned long long fraction = 0;
-    unsigned long long fraction_digits = 0;
-    long long exponent = 0;
+const oijson_node* oijson_dom_member(const oijson_dom* dom, const oijson_node* object, unsigned int index) {
+    const oijson_node* name = oijson_dom_name(dom, object, index);
+    return name ? name + 1 : 0;
+}
 
-    unsigned int size = value.size;
-    const char* integer_ptr = OIJSON_NULLCHAR;
-    unsigned int integer_size;
-    const char* fraction_ptr = OIJSON_NULLCHAR;
-    unsigned int fraction_size;
-    const char* exponent_ptr = OIJSON_NULLCHAR;
-    unsigned int exponent_size;
-    const char* ptr = oijson_internal_consume_number_info(value.buffer, &size, &integer_ptr, &integer_size, &fraction_ptr, &fraction_size, &exponent_ptr, &exponent_size);
-    if(!ptr) {
+const oijson_node* oijson_dom_value_by_name(const oijson_dom* dom, const oijson_node* object, const char* name) {
+    if (!object || object->type != oijson_type_object) {
+        oijson_internal_error_set("not an object");
         return 0;
     }
 
-    if (out) {
-        if (!oijson_internal_parse_ll(integer_ptr, integer_size, &integer)) {
-            return 0;
+    const oijson_node* names = &dom->nodes[object->data.children.first];
+    for (unsigned int i = 0; i < object->data.children.count * 2; i += 2) {
+        oijson name_json = {
+            .buffer = dom->buffer + names[i].offset,
+            .size = names[i].data.size,
+            .type = oijson_type_string,
+        };
+        if (oijson_internal_name_equals(name_json, name)) {
+            return &names[i + 1];
         }
-        *out = (long)integer;
-        if (fraction_ptr) {
-            if (!oijson_internal_parse_ull(fraction_ptr, fraction_size, &fraction)) {
-                return 0;
-            }
-            const char* ptr2 = fraction_ptr;
-            while (fraction_size && *ptr2 >= '0' && *ptr2 <= '9') {
-                fraction_digits++;
-                ptr2++;
-            }
+    }
+    oijson_internal_error_set_field("name not found", name);
+    return 0;
+}
 
-            double fraction_d = integer_ptr[0] == '-' ? -(double)fraction : (double)fraction;
-            while (fraction_digits) {
-                fraction_d /= 10.0;
-                fraction_digits--;
-            }
-            if (fraction_d < -0.5) {
-                (*out)--;
-            }
-            else if (fraction_d > 0.5) {
-                (*out)++;
-            }
-        }
-        if (exponent_ptr) {
-            if (!oijson_internal_parse_ll(exponent_ptr, exponent_size, &exponent)) {
-                return 0;
-            }
+// Only strings keep their size in a node. A container ends after its last child, so finding its end reads the last
+// child of each level down, then the whitespace and closing bracket of each level up, not the whole value.
+static unsigned int oijson_internal_dom_end(const oijson_dom* dom, const oijson_node* node) {
+    unsigned int levels = 0;
+    while ((node->type == oijson_type_object || node->type == oijson_type_array) && node->data.children.count) {
+        levels++;
+        node = &dom->nodes[node->data.children.first + node->data.children.count * (node->type == oijson_type_object ? 2 : 1) - 1];
+    }
 
-            while (exponent > 0) {
-                *out *= 10;
-                exponent--;
-            }
-            while (exponent < 0 && *out) {
-                *out /= 10;
-                exponent++;
-            }
+    unsigned int end = node->offset;
+    unsigned int size = dom->buffer_size - end;
+    switch (node->type) {
+        case oijson_type_object:
+        case oijson_type_array:// empty
+            levels++;
+            end++;
+            break;
+        case oijson_type_string:
+            end += node->data.size;
+            break;
+        case oijson_type_number:
+        {
+            oijson_internal_number parts;
+            end = (unsigned int)(oijson_internal_consume_number_parts(dom->buffer + end, &size, &parts) - dom->buffer);
+            break;
         }
+        default:
+            end += dom->buffer[end] == 'f' ? 5 : 4;
+            break;
     }
-
-    return 1;
+    for (; levels; levels--) {
+        size = dom->buffer_size - end;
+        end = (unsigned int)(oijson_internal_consume_whitespace(dom->buffer + end, &size) - dom->buffer) + 1;
+    }
+    return end;
 }
 
-int oijson_value_as_int(oijson value, int* out) {
-    long l;
-    if (oijson_value_as_long(value, &l)) {
-        if (out) {
-            *out = (int)l;
-        }
-        return 1;
+oijson oijson_dom_value(const oijson_dom* dom, const oijson_node* node) {
+    if (!dom || !node || node->type == oijson_type_invalid) {
+        oijson_internal_error_set("invalid node");
+        return OIJSON_INVALID;
     }
-    return 0;
+
+    oijson out_json = {
+        .buffer = dom->buffer + node->offset,
+        .size = oijson_internal_dom_end(dom, node) - node->offset,
+        .type = node->type,
+    };
+    return out_json;
 }
 
 static void oijson_internal_iterator_invalidate(oijson_iterator* iterator) {
@@ -1106,81 +5140,168 @@ static void oijson_internal_iterator_invalidate(oijson_iterator* iterator) {
     };
 }
 
-static void oijson_internal_iterator_update(oijson_iterator* iterator) {
+static int oijson_internal_iterator_update(oijson_iterator* iterator, int first) {// reads the element at ptr, leaving ptr at its end, returns 0 if it is malformed
+    char closing = iterator->type == oijson_iterator_type_object ? '}' : ']';
+    const char* itr = oijson_internal_consume_whitespace(iterator->ptr, &iterator->size);
+    if (!itr) {
+        oijson_internal_error_set("unexpected end of json string");
+        oijson_internal_iterator_invalidate(iterator);
+        return 0;
+    }
+    if (first && *itr == closing) {// empty container
+        oijson_internal_iterator_invalidate(iterator);
+        return 1;
+    }
+
     switch (iterator->type) {
         case oijson_iterator_type_object:
-            {
-                const char* name_start;
-                unsigned int name_size;
-                const char* value_start;
-                unsigned int value_size;
-                unsigned int temp_size = iterator->size;
-
-                const char* itr = oijson_internal_consume_name_value_pair(iterator->ptr, &temp_size, &name_start, &name_size, &value_start, &value_size);
-                if (!itr) {
-                    oijson_internal_iterator_invalidate(iterator);
-                    return;
-                }
-
-                iterator->name = oijson_parse(name_start, name_size);
-                iterator->value = oijson_parse(value_start, value_size);
+            if (*itr != '\"') {
+                oijson_internal_error_set("name expected");
+                itr = OIJSON_NULLCHAR;
+                break;
+            }
+            itr = oijson_internal_skip_value(itr, &iterator->size, &iterator->name);
+            itr = oijson_internal_consume_whitespace(itr, &iterator->size);
+            if (!itr || *itr != ':') {
+                oijson_internal_error_set("':' expected");
+                itr = OIJSON_NULLCHAR;
+                break;
             }
+            itr++;// skip ':'
+            iterator->size--;
+            itr = oijson_internal_skip_value(itr, &iterator->size, &iterator->value);
             break;
         case oijson_iterator_type_array:
-            {
-                const char* value_start = iterator->ptr;
-                unsigned int value_size = iterator->size;
-                const char* itr = oijson_internal_consume_value(iterator->ptr, &value_size);
-                if (!itr) {
-                    oijson_internal_iterator_invalidate(iterator);
-                    return;
-                }
-                value_size = iterator->size - value_size;
-
-                iterator->name = OIJSON_INVALID;
-                iterator->value = oijson_parse(value_start, value_size);
-            }
+            iterator->name = OIJSON_INVALID;
+            itr = oijson_internal_skip_value(itr, &iterator->size, &iterator->value);
             break;
         default:
-            oijson_internal_iterator_invalidate(iterator);
+            itr = OIJSON_NULLCHAR;
             break;
     }
+
+    if (!itr) {
+        oijson_internal_iterator_invalidate(iterator);
+        return 0;
+    }
+    iterator->ptr = itr;
+    return 1;
 }
 
-oijson_iterator oijson_iterator_create(oijson value) {
-    oijson_iterator iterator;
-    oijson_internal_iterator_invalidate(&iterator);
+static int oijson_internal_iterator_start(oijson value, oijson_iterator* iterator) {// returns 0 if the first element is malformed
+    oijson_internal_iterator_invalidate(iterator);
+    if (value.type != oijson_type_object && value.type != oijson_type_array) {
+        return 1;
+    }
+
+    iterator->type = value.type == oijson_type_object ? oijson_iterator_type_object : oijson_iterator_type_array;
+    iterator->size = value.size;
+    iterator->ptr = oijson_internal_consume_whitespace(value.buffer, &iterator->size);
+    iterator->ptr = oijson_internal_consume_utf8(iterator->ptr, &iterator->size);// skip '{' or '['
+    return oijson_internal_iterator_update(iterator, 1);
+}
 
-    if (value.type == oijson_type_object) {
-        iterator.type = oijson_iterator_type_object;
-        iterator.size = value.size;
-        iterator.ptr = oijson_internal_consume_whitespace(value.buffer, &iterator.size);
-        iterator.ptr = oijson_internal_consume_utf8(value.buffer, &iterator.size);// skip '{'
+static int oijson_internal_iterator_next(oijson_iterator* iterator) {// returns 0 if the separator or the next element is malformed
+    if (iterator->type != oijson_iterator_type_object && iterator->type != oijson_iterator_type_array) {
+        return 1;
+    }
+
+    char closing = iterator->type == oijson_iterator_type_object ? '}' : ']';
+    iterator->ptr = oijson_internal_consume_whitespace(iterator->ptr, &iterator->size);// ptr is already past the current element, only the separator is left
+    if (!iterator->ptr) {
+        oijson_internal_error_set("unexpected end of json string");
+        oijson_internal_iterator_invalidate(iterator);
+        return 0;
     }
-    else if (value.type == oijson_type_array) {
-        iterator.type = oijson_iterator_type_array;
-        iterator.size = value.size;
-        iterator.ptr = oijson_internal_consume_whitespace(value.buffer, &iterator.size);
-        iterator.ptr = oijson_internal_consume_utf8(value.buffer, &iterator.size);// skip '['
+    if (*iterator->ptr == closing) {
+        oijson_internal_iterator_invalidate(iterator);
+        return 1;
+    }
+    if (*iterator->ptr != ',') {
+        oijson_internal_error_set(closing == '}' ? "',' or '}' expected" : "',' or ']' expected");
+        oijson_internal_iterator_invalidate(iterator);
+        return 0;
     }
-    oijson_internal_iterator_update(&iterator);
+    iterator->ptr++;
+    iterator->size--;
+    return oijson_internal_iterator_update(iterator, 0);
+}
+
+oijson_iterator oijson_iterator_create(oijson value) {
+    oijson_iterator iterator;
+    oijson_internal_iterator_start(value, &iterator);
     return iterator;
 }
 
 void oijson_iterator_advance(oijson_iterator* iterator) {
-    switch (iterator->type) {
-        case oijson_iterator_type_object:
-            iterator->ptr = oijson_internal_consume_name_value_pair(iterator->ptr, &iterator->size, 0, 0, 0, 0);
-            iterator->ptr = oijson_internal_consume_whitespace(iterator->ptr, &iterator->size);
-            iterator->ptr = oijson_internal_consume_utf8(iterator->ptr, &iterator->size);// ','
-            break;
-        case oijson_iterator_type_array:
-            iterator->ptr = oijson_internal_consume_value(iterator->ptr, &iterator->size);
-            iterator->ptr = oijson_internal_consume_whitespace(iterator->ptr, &iterator->size);
-            iterator->ptr = oijson_internal_consume_utf8(iterator->ptr, &iterator->size);// ','
-            break;
-        default:
-            break;
+    oijson_internal_iterator_next(iterator);
+}
+
+oijson_cursor oijson_cursor_create(oijson value) {
+    oijson_cursor cursor = {
+        .value = value,
+        .iterator = oijson_iterator_create(value),
+        .index = 0,
+        .count = OIJSON_CURSOR_COUNT_UNKNOWN,
+    };
+    if (value.type != oijson_type_object && value.type != oijson_type_array) {
+        oijson_internal_error_set("not an object or array");
+        cursor.count = 0;
+    }
+    return cursor;
+}
+
+static const oijson_iterator* oijson_internal_cursor_seek(oijson_cursor* cursor, unsigned int index) {// resumes from the last index, restarting only to go back
+    if (index < cursor->index) {
+        cursor->iterator = oijson_iterator_create(cursor->value);
+        cursor->index = 0;
+    }
+    int valid = 1;
+    while (valid && cursor->iterator.type != oijson_iterator_type_invalid && cursor->index < index) {
+        valid = oijson_internal_iterator_next(&cursor->iterator);
+        cursor->index++;
+    }
+    if (valid && cursor->iterator.type == oijson_iterator_type_invalid) {
+        if (cursor->count == OIJSON_CURSOR_COUNT_UNKNOWN) {
+            cursor->count = cursor->index;
+        }
+        oijson_internal_error_set("index out of range");
+    }
+    return &cursor->iterator;
+}
+
+unsigned int oijson_cursor_count(oijson_cursor* cursor) {
+    if (!cursor) {
+        return 0;
+    }
+    if (cursor->count == OIJSON_CURSOR_COUNT_UNKNOWN) {// counts the rest from the current position, without moving it
+        oijson_iterator iterator = cursor->iterator;
+        unsigned int count = cursor->index;
+        int valid = 1;
+        while (valid && iterator.type != oijson_iterator_type_invalid) {
+            valid = oijson_internal_iterator_next(&iterator);
+            count++;
+        }
+        if (!valid) {// malformed, the error is kept and nothing is cached
+            return 0;
+        }
+        cursor->count = count;
+    }
+    return cursor->count;
+}
+
+oijson oijson_cursor_value_by_index(oijson_cursor* cursor, unsigned int index) {
+    if (!cursor) {
+        oijson_internal_error_set("invalid cursor");
+        return OIJSON_INVALID;
+    }
+    return oijson_internal_cursor_seek(cursor, index)->value;
+}
+
+oijson oijson_cursor_name_by_index(oijson_cursor* cursor, unsigned int index) {
+    if (!cursor) {
+        oijson_internal_error_set("invalid cursor");
+        return OIJSON_INVALID;
     }
-    oijson_internal_iterator_update(iterator);
+    return oijson_internal_cursor_seek(cursor, index)->name;
 }
@@ -1,6 +1,20 @@
 #ifndef OIJSON
 #define OIJSON
 
+#ifndef OIJSON_MAX_DEPTH
+#define OIJSON_MAX_DEPTH 1024// nesting limit of oijson_parse, define when compiling oijson.c to change it
+#endif
+
+#define OIJSON_INDEX_SIZE 32// size of an index written by oijson_index_save
+#define OIJSON_INDEX_NODE_SIZE 16// size of each node stored by oijson_index_save_dom, after the index and a 4 byte node count
+#define OIJSON_CACHE_WAYS 4// entries per set of an oijson_cache
+#define OIJSON_CURSOR_COUNT_UNKNOWN 0xFFFFFFFFu
+#define OIJSON_CHUNK_STACK_SIZE 128// one bit per nesting level of an oijson_chunk, fixed so its layout does not depend on OIJSON_MAX_DEPTH
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef enum oijson_type_e {
     oijson_type_invalid = 0,
     oijson_type_string,
@@ -12,6 +26,13 @@ typedef enum oijson_type_e {
     oijson_type_null,
 } oijson_type;
 
+typedef enum oijson_number_class_e {
+    oijson_number_class_invalid = 0,
+    oijson_number_class_integer,
+    oijson_number_class_real,
+    oijson_number_class_big,
+} oijson_number_class;
+
 typedef struct oijson_s {
     const char* buffer;
     unsigned int size;
@@ -32,26 +53,205 @@ typedef struct oijson_iterator_s {
     unsigned int size;
 } oijson_iterator;
 
+typedef struct oijson_cursor_s {
+    oijson value;
+    oijson_iterator iterator;// at element index
+    unsigned int index;
+    unsigned int count;// OIJSON_CURSOR_COUNT_UNKNOWN until the end is reached
+} oijson_cursor;
+
+typedef struct oijson_chunk_summary_s {// effect of a chunk on the nesting, assuming it starts outside or inside a string
+    unsigned char closers[OIJSON_CHUNK_STACK_SIZE];// closing containers opened before the chunk, set for objects
+    unsigned char openers[OIJSON_CHUNK_STACK_SIZE];// containers left open at the end, set for objects
+    unsigned int closer_count;
+    unsigned int opener_count;
+    unsigned char ends_in_string;
+    unsigned char last_token;
+    unsigned char before_last_token;
+} oijson_chunk_summary;
+
+typedef struct oijson_chunk_s {// part of a document, see oijson_chunk_split, fields are internal
+    const char* buffer;
+    unsigned int size;
+    unsigned int depth;// at the start of the chunk, once stitched
+    unsigned char stack[OIJSON_CHUNK_STACK_SIZE];
+    unsigned char state;
+    unsigned char status;
+    const char* value_end;// end of the document value, if it ends in this chunk
+    oijson_chunk_summary summaries[2];
+} oijson_chunk;
+
+typedef enum oijson_field_type_e {
+    oijson_field_type_value = 0,
+    oijson_field_type_double,
+    oijson_field_type_float,
+    oijson_field_type_long,
+    oijson_field_type_int,
+    oijson_field_type_bool,
+    oijson_field_type_string,
+    oijson_field_type_object,
+} oijson_field_type;
+
+typedef struct oijson_column_s {
+    const char* name;
+    oijson_field_type type;
+    void* data;
+    unsigned char* present;
+} oijson_column;
+
+typedef struct oijson_field_s {
+    const char* name;
+    oijson_field_type type;
+    unsigned int offset;
+    unsigned int size;
+    const struct oijson_field_s* fields;
+    unsigned int field_count;
+    int optional;
+} oijson_field;
+
+typedef int (*oijson_write_function)(void* user_data, const char* data, unsigned int size);
+typedef void (*oijson_lock_function)(void* user_data, unsigned int set);
+
+typedef struct oijson_cache_entry_s {
+    unsigned long long hash;
+    unsigned int json_size;// 0 for unused entries
+    unsigned int offset;
+    unsigned int size;
+    oijson_type type;
+    unsigned int stamp;
+} oijson_cache_entry;
+
+typedef struct oijson_cache_s {
+    oijson_cache_entry* entries;
+    unsigned int set_count;
+    char* bytes;// a copy of each cached document, to confirm hits
+    unsigned int slot_size;// bytes per entry
+    oijson_lock_function lock;
+    oijson_lock_function unlock;
+    void* user_data;
+} oijson_cache;
+
+typedef struct oijson_keyset_slot_s {
+    unsigned int hash;
+    int id;// index of the name, -1 for empty slots
+} oijson_keyset_slot;
+
+typedef struct oijson_keyset_s {
+    const char* const* names;
+    oijson_keyset_slot* slots;
+    unsigned int slot_count;
+} oijson_keyset;
+
+typedef struct oijson_number_s {
+    oijson_number_class number_class;
+    long long integer;// exact for integers, rounded to the nearest integer otherwise
+    double real;
+} oijson_number;
+
+typedef struct oijson_node_s {
+    oijson_type type;
+    unsigned int offset;// position of the value in the JSON string
+    union {
+        double real;// a number, oijson_value_as_number on oijson_dom_value keeps integers exact
+        unsigned int size;// of a string, including quotes
+        struct {
+            unsigned int first;// index of the first child node
+            unsigned int count;// elements of an array, or name/value pairs of an object
+        } children;
+    } data;
+} oijson_node;
+
+typedef struct oijson_dom_s {
+    oijson_node* nodes;
+    unsigned int capacity;
+    unsigned int count;
+    const char* buffer;
+    unsigned int buffer_size;
+} oijson_dom;
+
 const char* oijson_error(void);
 
 oijson oijson_parse(const char* json, unsigned int json_size);
+oijson oijson_parse_with_stack(const char* json, unsigned int json_size, unsigned char* stack, unsigned int stack_size);
+unsigned int oijson_parse_many(const char* const* jsons, const unsigned int* json_sizes, unsigned int count, oijson* out);
+oijson oijson_parse_lazy(const char* json, unsigned int json_size);
+oijson oijson_parse_chunked(const char* json, unsigned int json_size, oijson_chunk* chunks, unsigned int chunk_count);
+unsigned int oijson_chunk_split(const char* json, unsigned int json_size, oijson_chunk* chunks, unsigned int chunk_count);
+int oijson_chunk_scan(oijson_chunk* chunk);
+unsigned int oijson_chunk_stitch(oijson_chunk* chunks, unsigned int chunk_count);
+int oijson_chunk_validate(oijson_chunk* chunk);
+oijson oijson_chunk_result(const oijson_chunk* chunks, unsigned int chunk_count);
+int oijson_validate(oijson value);
+int oijson_minify(const char* json, unsigned int json_size, char* out, unsigned int out_size);
+int oijson_index_save(const char* json, unsigned int json_size, oijson value, unsigned char* out, unsigned int out_size);
+oijson oijson_index_load(const unsigned char* index, unsigned int index_size, const char* json, unsigned int json_size, int verify_checksum);
+int oijson_index_save_dom(const oijson_dom* dom, unsigned char* out, unsigned int out_size, unsigned int* out_written);
+int oijson_index_load_dom(const unsigned char* index, unsigned int index_size, const char* json, unsigned int json_size, int verify_checksum, oijson_dom* dom);
+
+oijson_cache oijson_cache_create(oijson_cache_entry* entries, unsigned int entry_count, char* bytes, unsigned int byte_count, oijson_lock_function lock, oijson_lock_function unlock, void* user_data);
+oijson oijson_cache_parse(oijson_cache* cache, const char* json, unsigned int json_size);
+
+oijson_keyset oijson_keyset_create(const char* const* names, unsigned int name_count, oijson_keyset_slot* slots, unsigned int slot_count);
+int oijson_keyset_find(const oijson_keyset* keyset, oijson name);
 
 unsigned int oijson_object_count(oijson object);
 oijson oijson_object_value_by_name(oijson object, const char* name);
+int oijson_find_all_by_key(oijson value, const char* name, oijson* out, unsigned int out_size, unsigned int* out_count);
 oijson oijson_object_name_by_index(oijson object, unsigned int index);
 oijson oijson_object_value_by_index(oijson object, unsigned int index);
 
 unsigned int oijson_array_count(oijson array);
 oijson oijson_array_value_by_index(oijson array, unsigned int index);
+int oijson_array_as_doubles(oijson array, double* out, unsigned int out_size, unsigned int* out_count);
+int oijson_array_as_floats(oijson array, float* out, unsigned int out_size, unsigned int* out_count);
+int oijson_array_as_longs(oijson array, long* out, unsigned int out_size, unsigned int* out_count);
+int oijson_array_as_ints(oijson array, int* out, unsigned int out_size, unsigned int* out_count);
+int oijson_array_extract_columns(oijson array, oijson_column* columns, unsigned int column_count, unsigned int row_capacity, unsigned int* out_rows);
 
 int oijson_value_formatted(oijson value, char* out, unsigned int out_size);// TODO: truncate if needed
+int oijson_value_pretty(oijson value, unsigned int indent, char* out, unsigned int out_size);
+int oijson_value_pretty_write(oijson value, unsigned int indent, oijson_write_function write, void* user_data);
+int oijson_merge_patch(oijson target, oijson patch, char* out, unsigned int out_size);
+int oijson_merge_patch_write(oijson target, oijson patch, oijson_write_function write, void* user_data);
+int oijson_json_patch(oijson target, oijson patch, char* out, unsigned int out_size, char* scratch, unsigned int scratch_size);
+int oijson_project(oijson value, const char* const* paths, unsigned int path_count, char* out, unsigned int out_size);
+int oijson_project_write(oijson value, const char* const* paths, unsigned int path_count, oijson_write_function write, void* user_data);
 int oijson_value_as_string(oijson value, char* out, unsigned int out_size);// TODO: truncate if needed
 int oijson_value_as_long(oijson value, long* out);
 int oijson_value_as_int(oijson value, int* out);
 int oijson_value_as_double(oijson value, double* out);
 int oijson_value_as_float(oijson value, float* out);
+int oijson_value_as_number(oijson value, oijson_number* out);
+int oijson_number_as_double(const oijson_number* number, double* out);
+int oijson_number_as_float(const oijson_number* number, float* out);
+int oijson_number_as_long(const oijson_number* number, long* out);
+int oijson_number_as_int(const oijson_number* number, int* out);
+int oijson_hash(oijson value, unsigned long long* out);
+int oijson_equal(oijson a, oijson b);
+int oijson_bind(oijson object, const oijson_field* fields, unsigned int field_count, void* out);
+int oijson_to_cbor(oijson value, unsigned char* out, unsigned int out_size, unsigned int* out_written);
+int oijson_to_msgpack(oijson value, unsigned char* out, unsigned int out_size, unsigned int* out_written);
+
+oijson_dom oijson_dom_create(oijson_node* nodes, unsigned int capacity);
+int oijson_dom_build(oijson_dom* dom, const char* json, unsigned int json_size);
+const oijson_node* oijson_dom_root(const oijson_dom* dom);
+unsigned int oijson_dom_count(const oijson_node* node);
+const oijson_node* oijson_dom_element(const oijson_dom* dom, const oijson_node* array, unsigned int index);
+const oijson_node* oijson_dom_name(const oijson_dom* dom, const oijson_node* object, unsigned int index);
+const oijson_node* oijson_dom_member(const oijson_dom* dom, const oijson_node* object, unsigned int index);
+const oijson_node* oijson_dom_value_by_name(const oijson_dom* dom, const oijson_node* object, const char* name);
+oijson oijson_dom_value(const oijson_dom* dom, const oijson_node* node);
 
 oijson_iterator oijson_iterator_create(oijson value);
 void oijson_iterator_advance(oijson_iterator* iterator);
 
+oijson_cursor oijson_cursor_create(oijson value);
+unsigned int oijson_cursor_count(oijson_cursor* cursor);
+oijson oijson_cursor_value_by_index(oijson_cursor* cursor, unsigned int index);
+oijson oijson_cursor_name_by_index(oijson_cursor* cursor, unsigned int index);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif//OIJSON
@@ -0,0 +1,1306 @@
+#ifndef OIJSON_HPP
+#define OIJSON_HPP
+
+#ifdef OIJSON
+#error "the C typedef oijson clashes with namespace oijson, include oijson.hpp instead of oijson.h"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define OIJSON_COROUTINES 1// enables oijson::async_parser
+#endif
+#endif
+
+#define oijson oijson_s// the C typedef takes the name of its struct tag, oijson names the namespace
+#include "oijson.h"
+#undef oijson
+
+namespace oijson {
+
+namespace c {// the C API, aliased out of the way of namespace oijson
+using oijson = ::oijson_s;
+using ::oijson_type, ::oijson_number_class, ::oijson_iterator_type, ::oijson_iterator, ::oijson_cursor, ::oijson_chunk_summary,
+    ::oijson_chunk, ::oijson_field_type, ::oijson_column, ::oijson_field, ::oijson_cache_entry, ::oijson_cache,
+    ::oijson_keyset_slot, ::oijson_keyset, ::oijson_number, ::oijson_node, ::oijson_dom, ::oijson_write_function,
+    ::oijson_lock_function;
+using ::oijson_type_invalid, ::oijson_type_string, ::oijson_type_number, ::oijson_type_object, ::oijson_type_array,
+    ::oijson_type_true, ::oijson_type_false, ::oijson_type_null, ::oijson_number_class_invalid, ::oijson_number_class_integer,
+    ::oijson_number_class_real, ::oijson_number_class_big, ::oijson_iterator_type_invalid, ::oijson_iterator_type_object,
+    ::oijson_iterator_type_array, ::oijson_field_type_value, ::oijson_field_type_double, ::oijson_field_type_float,
+    ::oijson_field_type_long, ::oijson_field_type_int, ::oijson_field_type_bool, ::oijson_field_type_string,
+    ::oijson_field_type_object;
+using ::oijson_error, ::oijson_parse, ::oijson_parse_with_stack, ::oijson_parse_many, ::oijson_parse_lazy,
+    ::oijson_parse_chunked, ::oijson_chunk_split, ::oijson_chunk_scan, ::oijson_chunk_stitch, ::oijson_chunk_validate,
+    ::oijson_chunk_result, ::oijson_validate, ::oijson_minify, ::oijson_index_save, ::oijson_index_load, ::oijson_cache_create,
+    ::oijson_index_save_dom, ::oijson_index_load_dom, ::oijson_cache_parse, ::oijson_keyset_create, ::oijson_keyset_find,
+    ::oijson_object_count, ::oijson_object_value_by_name,
+    ::oijson_find_all_by_key, ::oijson_object_name_by_index, ::oijson_object_value_by_index, ::oijson_array_count,
+    ::oijson_array_value_by_index, ::oijson_array_as_doubles, ::oijson_array_as_floats, ::oijson_array_as_longs,
+    ::oijson_array_as_ints, ::oijson_array_extract_columns, ::oijson_value_formatted, ::oijson_value_pretty,
+    ::oijson_value_pretty_write, ::oijson_merge_patch, ::oijson_merge_patch_write, ::oijson_json_patch, ::oijson_project,
+    ::oijson_project_write, ::oijson_value_as_string, ::oijson_value_as_long, ::oijson_value_as_int, ::oijson_value_as_double,
+    ::oijson_value_as_float, ::oijson_value_as_number, ::oijson_number_as_double, ::oijson_number_as_float,
+    ::oijson_number_as_long, ::oijson_number_as_int, ::oijson_hash, ::oijson_equal, ::oijson_bind, ::oijson_to_cbor,
+    ::oijson_to_msgpack, ::oijson_dom_create, ::oijson_dom_build, ::oijson_dom_root, ::oijson_dom_count, ::oijson_dom_element,
+    ::oijson_dom_name, ::oijson_dom_member, ::oijson_dom_value_by_name, ::oijson_dom_value, ::oijson_iterator_create,
+    ::oijson_iterator_advance, ::oijson_cursor_create, ::oijson_cursor_count, ::oijson_cursor_value_by_index,
+    ::oijson_cursor_name_by_index;
+}
+
+class value;
+class member_range;
+class element_range;
+
+template <class T>
+bool bind(value object, T& out) noexcept;
+
+// Specialize with a static constexpr tuple named list, made of oijson::field entries, to allow binding T.
+template <class T>
+struct fields;
+
+namespace detail {
+
+template <class T, class = void>
+struct has_fields : std::false_type {};
+
+template <class T>
+struct has_fields<T, std::void_t<decltype(fields<T>::list)>> : std::true_type {};
+
+constexpr std::size_t decode_size = 256;// scratch for keys containing escape sequences
+
+inline std::string_view unquote(c::oijson string) noexcept {
+    return string.size < 2 ? std::string_view() : std::string_view(string.buffer + 1, string.size - 2);
+}
+
+inline bool has_escape(std::string_view raw) noexcept {
+    return raw.find('\\') != std::string_view::npos;
+}
+
+}
+
+class value {
+public:
+    constexpr value() noexcept : m_json{ nullptr, 0, c::oijson_type_invalid } {}
+    constexpr explicit value(c::oijson json) noexcept : m_json(json) {}
+
+    static value parse(std::string_view json) noexcept {
+        return value(c::oijson_parse(json.data(), static_cast<unsigned int>(json.size())));
+    }
+    static value parse_lazy(std::string_view json) noexcept {// see oijson_parse_lazy, nothing is validated until accessed
+        return value(c::oijson_parse_lazy(json.data(), static_cast<unsigned int>(json.size())));
+    }
+    bool validate() const noexcept { return c::oijson_validate(m_json); }
+
+    constexpr c::oijson_type type() const noexcept { return m_json.type; }
+    constexpr bool valid() const noexcept { return m_json.type != c::oijson_type_invalid; }
+    constexpr explicit operator bool() const noexcept { return valid(); }
+    constexpr bool is_string() const noexcept { return m_json.type == c::oijson_type_string; }
+    constexpr bool is_number() const noexcept { return m_json.type == c::oijson_type_number; }
+    constexpr bool is_object() const noexcept { return m_json.type == c::oijson_type_object; }
+    constexpr bool is_array() const noexcept { return m_json.type == c::oijson_type_array; }
+    constexpr bool is_bool() const noexcept { return m_json.type == c::oijson_type_true || m_json.type == c::oijson_type_false; }
+    constexpr bool is_null() const noexcept { return m_json.type == c::oijson_type_null; }
+
+    constexpr std::string_view raw() const noexcept { return std::string_view(m_json.buffer, m_json.size); }
+    constexpr const c::oijson& c_value() const noexcept { return m_json; }
+
+    member_range members() const noexcept;
+    element_range elements() const noexcept;
+
+    value operator[](std::string_view name) const noexcept;
+    value operator[](unsigned int index) const noexcept { return value(c::oijson_array_value_by_index(m_json, index)); }
+
+    bool get(double& out) const noexcept { return c::oijson_value_as_double(m_json, &out); }
+    bool get(float& out) const noexcept { return c::oijson_value_as_float(m_json, &out); }
+    bool get(long& out) const noexcept { return c::oijson_value_as_long(m_json, &out); }
+    bool get(int& out) const noexcept { return c::oijson_value_as_int(m_json, &out); }
+    bool get(c::oijson_number& out) const noexcept { return c::oijson_value_as_number(m_json, &out); }
+    bool get(bool& out) const noexcept {
+        out = m_json.type == c::oijson_type_true;
+        return is_bool();
+    }
+    bool get(std::string_view& out) const noexcept {// raw contents, escape sequences are not decoded
+        out = detail::unquote(m_json);
+        return is_string();
+    }
+    template <std::size_t N>
+    bool get(char (&out)[N]) const noexcept { return c::oijson_value_as_string(m_json, out, N); }
+    bool get(value& out) const noexcept {
+        out = *this;
+        return valid();
+    }
+    template <class T>
+    std::enable_if_t<detail::has_fields<T>::value, bool> get(T& out) const noexcept { return bind(*this, out); }
+
+private:
+    c::oijson m_json;
+};
+
+// Name/value pair of an object. key is the name as written in the JSON string, without quotes and with escape sequences left as is.
+struct member {
+    std::string_view key;
+    value name;
+    value val;
+};
+
+namespace detail {
+
+inline bool key_equals(const member& m, std::string_view name) noexcept {
+    if (!has_escape(m.key)) {
+        return m.key == name;
+    }
+    char decoded[decode_size];
+    return c::oijson_value_as_string(m.name.c_value(), decoded, decode_size) && std::string_view(decoded) == name;
+}
+
+}
+
+class member_iterator {
+public:
+    member_iterator() noexcept : m_iterator() { m_iterator.type = c::oijson_iterator_type_invalid; }
+    explicit member_iterator(c::oijson object) noexcept : m_iterator(c::oijson_iterator_create(object)) {
+        if (object.type != c::oijson_type_object) {
+            m_iterator.type = c::oijson_iterator_type_invalid;
+        }
+    }
+
+    member operator*() const noexcept { return member{ detail::unquote(m_iterator.name), value(m_iterator.name), value(m_iterator.value) }; }
+    member_iterator& operator++() noexcept {
+        c::oijson_iterator_advance(&m_iterator);
+        return *this;
+    }
+    bool operator==(const member_iterator& other) const noexcept {// all finished iterators are equal
+        return m_iterator.type == other.m_iterator.type && (m_iterator.type == c::oijson_iterator_type_invalid || m_iterator.ptr == other.m_iterator.ptr);
+    }
+    bool operator!=(const member_iterator& other) const noexcept { return !(*this == other); }
+
+private:
+    c::oijson_iterator m_iterator;
+};
+
+class element_iterator {
+public:
+    element_iterator() noexcept : m_iterator() { m_iterator.type = c::oijson_iterator_type_invalid; }
+    explicit element_iterator(c::oijson array) noexcept : m_iterator(c::oijson_iterator_create(array)) {
+        if (array.type != c::oijson_type_array) {
+            m_iterator.type = c::oijson_iterator_type_invalid;
+        }
+    }
+
+    value operator*() const noexcept { return value(m_iterator.value); }
+    element_iterator& operator++() noexcept {
+        c::oijson_iterator_advance(&m_iterator);
+        return *this;
+    }
+    bool operator==(const element_iterator& other) const noexcept {
+        return m_iterator.type == other.m_iterator.type && (m_iterator.type == c::oijson_iterator_type_invalid || m_iterator.ptr == other.m_iterator.ptr);
+    }
+    bool operator!=(const element_iterator& other) const noexcept { return !(*this == other); }
+
+private:
+    c::oijson_iterator m_iterator;
+};
+
+class member_range {
+public:
+    explicit member_range(c::oijson object) noexcept : m_object(object) {}
+    member_iterator begin() const noexcept { return member_iterator(m_object); }
+    member_iterator end() const noexcept { return member_iterator(); }
+
+private:
+    c::oijson m_object;
+};
+
+class element_range {
+public:
+    explicit element_range(c::oijson array) noexcept : m_array(array) {}
+    element_iterator begin() const noexcept { return element_iterator(m_array); }
+    element_iterator end() const noexcept { return element_iterator(); }
+
+private:
+    c::oijson m_array;
+};
+
+inline member_range value::members() const noexcept {
+    return member_range(m_json);
+}
+
+inline element_range value::elements() const noexcept {
+    return element_range(m_json);
+}
+
+inline value value::operator[](std::string_view name) const noexcept {
+    for (const member& m : members()) {
+        if (detail::key_equals(m, name)) {
+            return m.val;
+        }
+    }
+    return value();
+}
+
+template <class Class, class Member>
+struct field_entry {
+    std::string_view name;
+    Member Class::*pointer;
+    bool optional;
+};
+
+template <class Class, class Member>
+constexpr field_entry<Class, Member> field(std::string_view name, Member Class::*pointer, bool optional = false) noexcept {
+    return field_entry<Class, Member>{ name, pointer, optional };
+}
+
+namespace detail {
+
+template <class T>
+constexpr std::size_t field_count = std::tuple_size_v<std::decay_t<decltype(fields<T>::list)>>;
+
+template <class T, std::size_t... I>
+constexpr unsigned long long required_mask(std::index_sequence<I...>) noexcept {
+    return (0ULL | ... | (std::get<I>(fields<T>::list).optional ? 0ULL : 1ULL << I));
+}
+
+template <class T, std::size_t I>
+bool bind_field(value val, T& out) noexcept {
+    return val.get(out.*(std::get<I>(fields<T>::list).pointer));
+}
+
+template <std::size_t Count, std::size_t Longest>
+struct name_buckets {// field indices by name length, names of length n are those of order[starts[n]] to order[starts[n + 1]]
+    std::size_t starts[Longest + 2];
+    std::size_t order[Count];
+};
+
+template <class T, std::size_t... I>
+constexpr std::size_t longest_name(std::index_sequence<I...>) noexcept {
+    std::size_t longest = 0;
+    ((longest = std::get<I>(fields<T>::list).name.size() > longest ? std::get<I>(fields<T>::list).name.size() : longest), ...);
+    return longest;
+}
+
+template <class T, std::size_t Longest, std::size_t... I>
+constexpr name_buckets<sizeof...(I), Longest> bucket_names(std::index_sequence<I...>) noexcept {
+    constexpr std::size_t sizes[] = { std::get<I>(fields<T>::list).name.size()... };
+    name_buckets<sizeof...(I), Longest> buckets{};
+    std::size_t next[Longest + 1] = {};
+    for (std::size_t size : sizes) {
+        next[size]++;
+    }
+    for (std::size_t n = 0; n <= Longest; n++) {
+        buckets.starts[n + 1] = buckets.starts[n] + next[n];
+        next[n] = buckets.starts[n];
+    }
+    for (std::size_t i = 0; i < sizeof...(I); i++) {
+        buckets.order[next[sizes[i]]++] = i;
+    }
+    return buckets;
+}
+
+// Switches on the key length first, through buckets built at compile time, then compares the key with the few field
+// names of that length. Returns 1 when a field was bound, 0 for unknown keys and -1 on errors.
+template <class T, std::size_t... I>
+int bind_member(std::string_view key, value val, T& out, unsigned long long& found, std::index_sequence<I...>) noexcept {
+    if constexpr (sizeof...(I) == 0) {
+        return 0;
+    }
+    else {
+        constexpr std::size_t longest = longest_name<T>(std::index_sequence<I...>());
+        static constexpr name_buckets<sizeof...(I), longest> buckets = bucket_names<T, longest>(std::index_sequence<I...>());
+        static constexpr std::string_view names[] = { std::get<I>(fields<T>::list).name... };
+        static constexpr bool (*binders[])(value, T&) noexcept = { &bind_field<T, I>... };
+        if (key.size() > longest) {
+            return 0;
+        }
+        for (std::size_t i = buckets.starts[key.size()]; i < buckets.starts[key.size() + 1]; i++) {
+            std::size_t index = buckets.order[i];
+            if (key == names[index]) {
+                found |= 1ULL << index;
+                return binders[index](val, out) ? 1 : -1;
+            }
+        }
+        return 0;
+    }
+}
+
+}
+
+template <class T>
+bool bind(value object, T& out) noexcept {
+    static_assert(detail::has_fields<T>::value, "specialize oijson::fields<T> to bind T");
+    constexpr std::size_t count = detail::field_count<T>;
+    static_assert(count <= 64, "at most 64 fields can be bound");
+    constexpr auto indices = std::make_index_sequence<count>();
+
+    if (!object.is_object()) {
+        return false;
+    }
+
+    unsigned long long found = 0;
+    for (const member& m : object.members()) {
+        if (m.val.is_null()) {// null is treated as missing
+            continue;
+        }
+        std::string_view key = m.key;
+        char decoded[detail::decode_size];
+        if (detail::has_escape(key)) {
+            if (!c::oijson_value_as_string(m.name.c_value(), decoded, detail::decode_size)) {
+                continue;
+            }
+            key = std::string_view(decoded);
+        }
+        if (detail::bind_member(key, m.val, out, found, indices) < 0) {
+            return false;
+        }
+    }
+
+    constexpr unsigned long long required = detail::required_mask<T>(indices);
+    return (found & required) == required;
+}
+
+// Compile time validation, following the rules of oijson_parse: strict RFC 8259, UTF-8 checks and the same nesting
+// limit. Every function returns the index past what it consumed, or npos when the JSON is invalid.
+namespace detail {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+constexpr bool is_space(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+constexpr bool is_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+constexpr int hex_digit(char c) noexcept {
+    return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+constexpr std::size_t skip_space(std::string_view json, std::size_t i) noexcept {
+    while (i < json.size() && is_space(json[i])) {
+        i++;
+    }
+    return i;
+}
+
+constexpr std::size_t scan_hex4(std::string_view json, std::size_t i, unsigned int& out) noexcept {
+    out = 0;
+    if (i + 4 > json.size()) {
+        return npos;
+    }
+    for (std::size_t k = 0; k < 4; k++) {
+        int digit = hex_digit(json[i + k]);
+        if (digit < 0) {
+            return npos;
+        }
+        out = out * 16 + static_cast<unsigned int>(digit);
+    }
+    return i + 4;
+}
+
+// Reads the code point of an escape sequence, i is past the backslash. Surrogate pairs must be complete.
+constexpr std::size_t scan_escape(std::string_view json, std::size_t i, unsigned int& out) noexcept {
+    if (i >= json.size()) {
+        return npos;
+    }
+    switch (json[i]) {
+        case '\"': out = '\"'; return i + 1;
+        case '\\': out = '\\'; return i + 1;
+        case '/': out = '/'; return i + 1;
+        case 'b': out = '\b'; return i + 1;
+        case 'f': out = '\f'; return i + 1;
+        case 'n': out = '\n'; return i + 1;
+        case 'r': out = '\r'; return i + 1;
+        case 't': out = '\t'; return i + 1;
+        case 'u': break;
+        default: return npos;
+    }
+    i = scan_hex4(json, i + 1, out);
+    if (i == npos || out < 0xd800 || out >= 0xe000) {
+        return i;
+    }
+    unsigned int low = 0;
+    if (out >= 0xdc00 || i + 2 > json.size() || json[i] != '\\' || json[i + 1] != 'u') {
+        return npos;
+    }
+    i = scan_hex4(json, i + 2, low);
+    if (i == npos || low < 0xdc00 || low >= 0xe000) {
+        return npos;
+    }
+    out = 0x10000 + ((out - 0xd800) << 10) + (low - 0xdc00);
+    return i;
+}
+
+constexpr std::size_t scan_utf8(std::string_view json, std::size_t i) noexcept {
+    unsigned int lead = static_cast<unsigned char>(json[i]);
+    std::size_t count = 1;
+    if (lead & 0x80) {
+        count = 0;
+        while (count < 5 && ((lead >> (7 - count)) & 1)) {
+            count++;
+        }
+        if (count == 1 || count > 4) {
+            return npos;
+        }
+    }
+    if (json.size() - i < count) {
+        return npos;
+    }
+    for (std::size_t k = 0; k < count; k++) {
+        unsigned int byte = static_cast<unsigned char>(json[i + k]);
+        if (byte == 0xc0 || byte == 0xc1 || byte >= 0xf5 || (k && (byte & 0xc0) != 0x80)) {
+            return npos;
+        }
+    }
+    return i + count;
+}
+
+constexpr std::size_t scan_string(std::string_view json, std::size_t i) noexcept {// i is at the opening quote
+    i++;
+    while (i < json.size()) {
+        char c = json[i];
+        if (c == '\"') {
+            return i + 1;
+        }
+        if (c == '\\') {
+            unsigned int code_point = 0;
+            i = scan_escape(json, i + 1, code_point);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            return npos;
+        }
+        else {
+            i = scan_utf8(json, i);
+        }
+    }
+    return npos;
+}
+
+constexpr std::size_t scan_digits(std::string_view json, std::size_t i) noexcept {// at least one digit
+    if (i >= json.size() || !is_digit(json[i])) {
+        return npos;
+    }
+    while (i < json.size() && is_digit(json[i])) {
+        i++;
+    }
+    return i;
+}
+
+constexpr std::size_t scan_number(std::string_view json, std::size_t i) noexcept {
+    if (json[i] == '-') {
+        i++;
+    }
+    i = i < json.size() && json[i] == '0' ? i + 1 : scan_digits(json, i);
+    if (i != npos && i < json.size() && json[i] == '.') {
+        i = scan_digits(json, i + 1);
+    }
+    if (i != npos && i < json.size() && (json[i] == 'e' || json[i] == 'E')) {
+        i++;
+        if (i < json.size() && (json[i] == '+' || json[i] == '-')) {
+            i++;
+        }
+        i = scan_digits(json, i);
+    }
+    return i;
+}
+
+constexpr std::size_t scan_keyword(std::string_view json, std::size_t i, std::string_view keyword) noexcept {
+    return json.substr(i, keyword.size()) == keyword ? i + keyword.size() : npos;
+}
+
+constexpr std::size_t scan_scalar(std::string_view json, std::size_t i) noexcept {
+    switch (json[i]) {
+        case '\"': return scan_string(json, i);
+        case 't': return scan_keyword(json, i, "true");
+        case 'f': return scan_keyword(json, i, "false");
+        case 'n': return scan_keyword(json, i, "null");
+        default: return json[i] == '-' || is_digit(json[i]) ? scan_number(json, i) : npos;
+    }
+}
+
+constexpr std::size_t scan_name(std::string_view json, std::size_t i) noexcept {// a name and its colon
+    i = skip_space(json, i);
+    if (i >= json.size() || json[i] != '\"') {
+        return npos;
+    }
+    i = skip_space(json, scan_string(json, i));
+    return i < json.size() && json[i] == ':' ? i + 1 : npos;
+}
+
+// Iterative like oijson_parse, with one bit per level telling objects from arrays.
+constexpr std::size_t scan_value(std::string_view json, std::size_t i) noexcept {
+    unsigned char objects[(OIJSON_MAX_DEPTH + 7) / 8] = {};
+    std::size_t depth = 0;
+    while (true) {// a value starts at i
+        i = skip_space(json, i);
+        if (i >= json.size()) {
+            return npos;
+        }
+        char open = json[i];
+        if (open == '{' || open == '[') {
+            if (depth == OIJSON_MAX_DEPTH) {
+                return npos;
+            }
+            unsigned int bit = 1u << (depth % 8);
+            objects[depth / 8] = static_cast<unsigned char>(open == '{' ? objects[depth / 8] | bit : objects[depth / 8] & ~bit);
+            depth++;
+            i = skip_space(json, i + 1);
+            if (i >= json.size()) {
+                return npos;
+            }
+            if (json[i] != (open == '{' ? '}' : ']')) {
+                if (open == '{' && (i = scan_name(json, i)) == npos) {
+                    return npos;
+                }
+                continue;
+            }
+            i++;
+            depth--;
+        }
+        else if ((i = scan_scalar(json, i)) == npos) {
+            return npos;
+        }
+
+        while (true) {// the value is complete, close containers until the next value
+            if (!depth) {
+                return i;
+            }
+            bool object = (objects[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            i = skip_space(json, i);
+            if (i >= json.size()) {
+                return npos;
+            }
+            if (json[i] == (object ? '}' : ']')) {
+                i++;
+                depth--;
+                continue;
+            }
+            if (json[i] != ',' || (object && (i = scan_name(json, i + 1)) == npos)) {
+                return npos;
+            }
+            if (!object) {
+                i++;
+            }
+            break;
+        }
+    }
+}
+
+// Skims a value that was already validated.
+constexpr std::size_t skip_value(std::string_view json, std::size_t i) noexcept {
+    std::size_t depth = 0;
+    do {
+        char c = json[i];
+        if (c == '\"') {
+            for (i++; json[i] != '\"'; i++) {
+                if (json[i] == '\\') {
+                    i++;
+                }
+            }
+            i++;
+        }
+        else if (c == '{' || c == '[') {
+            depth++;
+            i++;
+        }
+        else if (c == '}' || c == ']') {
+            depth--;
+            i++;
+        }
+        else if (depth) {
+            i++;
+        }
+        else {
+            while (i < json.size() && !is_space(json[i]) && json[i] != ',' && json[i] != '}' && json[i] != ']') {
+                i++;
+            }
+        }
+    } while (depth);
+    return i;
+}
+
+// Compares a raw string, without its quotes, with a name, decoding escape sequences on the way.
+constexpr bool name_equals(std::string_view raw, std::string_view name) noexcept {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < raw.size();) {
+        if (raw[i] != '\\') {
+            if (n == name.size() || raw[i] != name[n]) {
+                return false;
+            }
+            i++;
+            n++;
+            continue;
+        }
+        unsigned int code_point = 0;
+        i = scan_escape(raw, i + 1, code_point);
+        std::size_t count = code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+        if (name.size() - n < count) {
+            return false;
+        }
+        for (std::size_t k = 0; k < count; k++) {// UTF-8 encoding of the code point
+            unsigned int shift = static_cast<unsigned int>(6 * (count - 1 - k));
+            unsigned int lead = count == 1 ? 0 : (0xf0u << (4 - count)) & 0xffu;
+            unsigned int byte = k ? 0x80 | ((code_point >> shift) & 0x3f) : lead | (code_point >> shift);
+            if (static_cast<unsigned char>(name[n + k]) != byte) {
+                return false;
+            }
+        }
+        n += count;
+    }
+    return n == name.size();
+}
+
+constexpr std::size_t scan_document(std::string_view json, std::size_t begin) noexcept {// begin is past leading whitespace
+    std::size_t end = begin < json.size() ? scan_value(json, begin) : npos;
+    std::size_t rest = end == npos ? end : skip_space(json, end);
+    return rest == npos || (rest < json.size() && json[rest] != '\0') ? npos : end;// like oijson_parse, stops at a null
+}
+
+constexpr c::oijson_type type_of(char first) noexcept {// of a valid value
+    switch (first) {
+        case '\"': return c::oijson_type_string;
+        case '{': return c::oijson_type_object;
+        case '[': return c::oijson_type_array;
+        case 't': return c::oijson_type_true;
+        case 'f': return c::oijson_type_false;
+        case 'n': return c::oijson_type_null;
+        default: return c::oijson_type_number;
+    }
+}
+
+// Parts of a valid number, converted the way oijson.c does, in unsigned arithmetic so that overflow wraps instead of
+// stopping constant evaluation.
+struct number_parts {
+    std::string_view integer;// with its sign
+    std::string_view fraction;// digits after the dot
+    std::string_view exponent;// with its sign
+};
+
+constexpr number_parts split_number(std::string_view raw) noexcept {
+    number_parts parts{};
+    std::size_t i = raw[0] == '-' ? 1 : 0;
+    while (i < raw.size() && is_digit(raw[i])) {
+        i++;
+    }
+    parts.integer = raw.substr(0, i);
+    if (i < raw.size() && raw[i] == '.') {
+        std::size_t begin = ++i;
+        while (i < raw.size() && is_digit(raw[i])) {
+            i++;
+        }
+        parts.fraction = raw.substr(begin, i - begin);
+    }
+    if (i < raw.size()) {
+        parts.exponent = raw.substr(i + 1);
+    }
+    return parts;
+}
+
+constexpr unsigned long long parse_signed(std::string_view digits) noexcept {// two's complement of the value
+    unsigned long long out = 0;
+    for (char c : digits) {
+        if (is_digit(c)) {
+            out = out * 10 + static_cast<unsigned long long>(c - '0');
+        }
+    }
+    return !digits.empty() && digits[0] == '-' ? 0 - out : out;
+}
+
+constexpr long double power_of_ten(unsigned int n) noexcept {// exact up to 10^22, or 10^27 with a 64-bit long double mantissa
+    long double result = 1.0L;
+    long double base = 10.0L;
+    while (n) {
+        if (n & 1) {
+            result *= base;
+        }
+        base *= base;
+        n >>= 1;
+    }
+    return result;
+}
+
+// Up to 19 significant digits, rounded on the 20th, scaled by one power of ten, in the same steps as oijson.c
+constexpr double number_to_double(std::string_view raw) noexcept {
+    number_parts parts = split_number(raw);
+    bool negative = parts.integer[0] == '-';
+    std::string_view integer = parts.integer.substr(negative ? 1 : 0);
+    std::size_t size = integer.size() + parts.fraction.size();
+    auto digit = [&](std::size_t i) { return i < integer.size() ? integer[i] : parts.fraction[i - integer.size()]; };
+    std::size_t first = 0;
+    while (first < size && digit(first) == '0') {
+        first++;
+    }
+    if (first == size) {
+        return 0.0;
+    }
+    std::size_t last = size;
+    while (digit(last - 1) == '0') {
+        last--;
+    }
+
+    std::string_view exponent_digits = parts.exponent.substr(!parts.exponent.empty() && (parts.exponent[0] == '-' || parts.exponent[0] == '+') ? 1 : 0);
+    while (exponent_digits.size() > 1 && exponent_digits[0] == '0') {
+        exponent_digits.remove_prefix(1);
+    }
+    if (exponent_digits.size() > 18) {// 0 or infinity
+        double saturated = parts.exponent[0] == '-' ? 0.0 : static_cast<double>(power_of_ten(800));
+        return negative ? -saturated : saturated;
+    }
+
+    std::size_t count = last - first < 19 ? last - first : 19;
+    unsigned long long significand = 0;
+    for (std::size_t i = first; i < first + count; i++) {
+        significand = significand * 10 + static_cast<unsigned long long>(digit(i) - '0');
+    }
+    if (first + count < last && digit(first + count) >= '5') {
+        significand++;
+    }
+
+    long long exponent = static_cast<long long>(parse_signed(parts.exponent)) + static_cast<long long>(integer.size()) -
+        static_cast<long long>(first) - static_cast<long long>(count);
+    long double scaled = static_cast<long double>(significand);
+    if (exponent >= 0) {
+        scaled *= power_of_ten(exponent > 800 ? 800 : static_cast<unsigned int>(exponent));
+    }
+    else if (exponent >= -308) {
+        scaled /= power_of_ten(static_cast<unsigned int>(-exponent));
+    }
+    else {
+        scaled /= power_of_ten(308);
+        scaled /= power_of_ten(exponent < -800 ? 800 : static_cast<unsigned int>(-exponent - 308));
+    }
+    double out = static_cast<double>(scaled);
+    return negative ? -out : out;
+}
+
+constexpr bool number_to_long(std::string_view raw, long& out) noexcept {// false when out of range, as in oijson.c
+    number_parts parts = split_number(raw);
+    bool negative = parts.integer[0] == '-';
+    std::string_view digits = parts.integer.substr(negative ? 1 : 0);
+    std::string_view limit_digits = negative ? "9223372036854775808" : "9223372036854775807";
+    unsigned long long limit = negative ? 9223372036854775808ULL : 9223372036854775807ULL;
+    bool fits = digits.size() < limit_digits.size() || (digits.size() == limit_digits.size() && digits <= limit_digits);
+    unsigned long long magnitude = fits ? parse_signed(digits) : 0;
+    if (fits && !parts.fraction.empty()) {
+        double fraction = static_cast<double>(parse_signed(parts.fraction));
+        for (std::size_t i = 0; i < parts.fraction.size(); i++) {
+            fraction /= 10.0;
+        }
+        if (fraction > 0.5) {// away from zero
+            fits = magnitude < limit;
+            magnitude++;
+        }
+    }
+    if (fits && !parts.exponent.empty() && magnitude) {
+        bool exponent_negative = parts.exponent[0] == '-';
+        std::string_view exponent_digits = parts.exponent.substr(exponent_negative || parts.exponent[0] == '+' ? 1 : 0);
+        while (exponent_digits.size() > 1 && exponent_digits[0] == '0') {
+            exponent_digits.remove_prefix(1);
+        }
+        unsigned long long exponent = exponent_digits.size() <= 2 ? parse_signed(exponent_digits) : 20;// 10^20 scales every long to 0 or out of range
+        for (; exponent && magnitude && fits; exponent--) {
+            if (exponent_negative) {
+                magnitude /= 10;
+            }
+            else if (magnitude > limit / 10) {
+                fits = false;
+            }
+            else {
+                magnitude *= 10;
+            }
+        }
+    }
+    long long integer = negative ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude);
+    fits = fits && static_cast<long long>(static_cast<long>(integer)) == integer;
+    out = fits ? static_cast<long>(integer) : 0;
+    return fits;
+}
+
+inline void invalid_json_literal() noexcept {}// not constexpr, calling it is a compile error in constant evaluation
+
+}
+
+// True if oijson_parse would accept json, usable in constant expressions.
+constexpr bool is_valid(std::string_view json) noexcept {
+    return detail::scan_document(json, detail::skip_space(json, 0)) != detail::npos;
+}
+
+// A JSON document embedded in the program. A constexpr literal is validated at compile time, so invalid JSON does not
+// compile, and lookups and conversions on it fold to constants. Outside of constant evaluation invalid JSON gives an
+// invalid literal. Names are compared with escape sequences decoded, and numbers convert as they do in oijson.c.
+class literal {
+public:
+    constexpr literal() noexcept = default;
+    constexpr explicit literal(std::string_view json) noexcept {
+        std::size_t begin = detail::skip_space(json, 0);
+        std::size_t end = detail::scan_document(json, begin);
+        if (end == detail::npos) {
+            detail::invalid_json_literal();
+            return;
+        }
+        m_raw = json.substr(begin, end - begin);
+        m_type = detail::type_of(m_raw[0]);
+    }
+
+    constexpr c::oijson_type type() const noexcept { return m_type; }
+    constexpr bool valid() const noexcept { return m_type != c::oijson_type_invalid; }
+    constexpr explicit operator bool() const noexcept { return valid(); }
+    constexpr bool is_string() const noexcept { return m_type == c::oijson_type_string; }
+    constexpr bool is_number() const noexcept { return m_type == c::oijson_type_number; }
+    constexpr bool is_object() const noexcept { return m_type == c::oijson_type_object; }
+    constexpr bool is_array() const noexcept { return m_type == c::oijson_type_array; }
+    constexpr bool is_bool() const noexcept { return m_type == c::oijson_type_true || m_type == c::oijson_type_false; }
+    constexpr bool is_null() const noexcept { return m_type == c::oijson_type_null; }
+
+    constexpr std::string_view raw() const noexcept { return m_raw; }
+    constexpr value to_value() const noexcept {
+        return value(c::oijson{ m_raw.data(), static_cast<unsigned int>(m_raw.size()), m_type });
+    }
+
+    constexpr literal operator[](std::string_view name) const noexcept {
+        if (!is_object()) {
+            return literal();
+        }
+        for (std::size_t i = detail::skip_space(m_raw, 1); m_raw[i] != '}';) {
+            std::size_t name_end = detail::skip_value(m_raw, i);
+            std::size_t begin = detail::skip_space(m_raw, detail::skip_space(m_raw, name_end) + 1);
+            std::size_t end = detail::skip_value(m_raw, begin);
+            if (detail::name_equals(m_raw.substr(i + 1, name_end - i - 2), name)) {
+                return child(begin, end);
+            }
+            i = next(end);
+        }
+        return literal();
+    }
+    constexpr literal operator[](unsigned int index) const noexcept {
+        if (!is_array()) {
+            return literal();
+        }
+        for (std::size_t i = detail::skip_space(m_raw, 1); m_raw[i] != ']'; index--) {
+            std::size_t end = detail::skip_value(m_raw, i);
+            if (!index) {
+                return child(i, end);
+            }
+            i = next(end);
+        }
+        return literal();
+    }
+    constexpr unsigned int size() const noexcept {// members of an object or elements of an array, 0 for other values
+        unsigned int count = 0;
+        if (is_object() || is_array()) {
+            for (std::size_t i = detail::skip_space(m_raw, 1); i + 1 < m_raw.size(); count++) {
+                i = is_object() ? detail::skip_space(m_raw, detail::skip_space(m_raw, detail::skip_value(m_raw, i)) + 1) : i;
+                i = next(detail::skip_value(m_raw, i));
+            }
+        }
+        return count;
+    }
+
+    constexpr bool get(double& out) const noexcept {
+        out = is_number() ? detail::number_to_double(m_raw) : 0.0;
+        return is_number();
+    }
+    constexpr bool get(float& out) const noexcept {
+        out = is_number() ? static_cast<float>(detail::number_to_double(m_raw)) : 0.0f;
+        return is_number();
+    }
+    constexpr bool get(long& out) const noexcept {
+        out = 0;
+        return is_number() && detail::number_to_long(m_raw, out);
+    }
+    constexpr bool get(int& out) const noexcept {// fails out of the range of an int, as oijson_value_as_int does
+        long l = 0;
+        bool fits = is_number() && detail::number_to_long(m_raw, l) && static_cast<long>(static_cast<int>(l)) == l;
+        out = fits ? static_cast<int>(l) : 0;
+        return fits;
+    }
+    constexpr bool get(bool& out) const noexcept {
+        out = m_type == c::oijson_type_true;
+        return is_bool();
+    }
+    constexpr bool get(std::string_view& out) const noexcept {// raw contents, escape sequences are not decoded
+        out = is_string() ? m_raw.substr(1, m_raw.size() - 2) : std::string_view();
+        return is_string();
+    }
+    template <class T>
+    constexpr T value_or(T fallback) const noexcept {
+        T out{};
+        return get(out) ? out : fallback;
+    }
+
+private:
+    constexpr literal child(std::size_t begin, std::size_t end) const noexcept {
+        literal out;
+        out.m_raw = m_raw.substr(begin, end - begin);
+        out.m_type = detail::type_of(out.m_raw[0]);
+        return out;
+    }
+    constexpr std::size_t next(std::size_t end) const noexcept {// from the end of a value to the start of the next one
+        std::size_t i = detail::skip_space(m_raw, end);
+        return m_raw[i] == ',' ? detail::skip_space(m_raw, i + 1) : i;
+    }
+
+    std::string_view m_raw;
+    c::oijson_type m_type = c::oijson_type_invalid;
+};
+
+// Finds complete JSON values in a stream of bytes arriving in chunks, keeping them in a buffer provided by the caller.
+// Bytes are scanned once, counting brackets and quotes, and each complete value is then validated by oijson_parse.
+// With split::values the stream is a sequence of values separated by whitespace, as in newline delimited JSON. With
+// split::elements the stream holds arrays whose elements are returned one at a time.
+enum class split {
+    values,
+    elements,
+};
+
+class stream_splitter {
+public:
+    stream_splitter(char* buffer, std::size_t capacity, split mode = split::values) noexcept
+        : m_buffer(buffer), m_capacity(buffer ? capacity : 0), m_mode(mode) {}
+
+    // Free space to read into, after moving pending bytes to the front. A value returned by next() points into the
+    // buffer, and stays valid until the next call to a non-const member function.
+    char* space() noexcept {
+        compact();
+        return m_buffer + m_size;
+    }
+    std::size_t space_size() const noexcept { return m_capacity - m_size; }
+    void commit(std::size_t size) noexcept { m_size += size < space_size() ? size : space_size(); }
+    std::size_t feed(std::string_view data) noexcept {// copies as much of data as fits, returning the amount copied
+        char* out = space();
+        std::size_t size = data.size() < space_size() ? data.size() : space_size();
+        for (std::size_t i = 0; i < size; i++) {
+            out[i] = data[i];
+        }
+        commit(size);
+        return size;
+    }
+    void finish() noexcept { m_finished = true; }// no more bytes will arrive
+
+    value next() noexcept;// the next complete value, or an invalid value if more bytes are needed, at the end or on errors
+    bool failed() const noexcept { return m_error != nullptr; }
+    bool done() const noexcept { return m_finished && !m_in_value && m_scan == m_size && !failed(); }
+    const char* error() const noexcept { return m_error; }
+
+private:
+    enum class frame {// position around the elements of an array, for split::elements
+        outside,
+        first,
+        element,
+        separator,
+    };
+
+    static bool is_whitespace(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+    static bool ends_scalar(char c) noexcept {
+        return is_whitespace(c) || c == ',' || c == ':' || c == '[' || c == ']' || c == '{' || c == '}' || c == '\"';
+    }
+
+    void compact() noexcept {
+        if (!m_consumed) {
+            return;
+        }
+        for (std::size_t i = m_consumed; i < m_size; i++) {
+            m_buffer[i - m_consumed] = m_buffer[i];
+        }
+        m_size -= m_consumed;
+        m_scan -= m_consumed;
+        m_start = m_in_value ? m_start - m_consumed : 0;
+        m_consumed = 0;
+    }
+    value fail(const char* error) noexcept {
+        m_error = error;
+        return value();
+    }
+    value complete(std::size_t end) noexcept {
+        m_in_value = false;
+        m_consumed = end;
+        m_frame = m_mode == split::elements ? frame::separator : frame::outside;
+        value result(c::oijson_parse(m_buffer + m_start, static_cast<unsigned int>(end - m_start)));
+        return result.valid() ? result : fail(c::oijson_error());
+    }
+    bool step_outside(char c) noexcept;// handles a byte between values, returns false on errors
+
+    char* m_buffer;
+    std::size_t m_capacity;
+    split m_mode;
+    std::size_t m_size = 0;
+    std::size_t m_scan = 0;// next byte to look at
+    std::size_t m_start = 0;// start of the value being scanned
+    std::size_t m_consumed = 0;// bytes before this are no longer needed
+    std::size_t m_depth = 0;
+    bool m_in_value = false;
+    bool m_in_string = false;
+    bool m_escape = false;
+    bool m_scalar = false;
+    bool m_finished = false;
+    frame m_frame = frame::outside;
+    const char* m_error = nullptr;
+};
+
+inline bool stream_splitter::step_outside(char c) noexcept {
+    if (m_mode == split::values) {
+        return true;
+    }
+    switch (m_frame) {
+        case frame::outside:
+            if (c != '[') {
+                m_error = "'[' expected";
+                return false;
+            }
+            m_frame = frame::first;
+            break;
+        case frame::first:
+            if (c != ']') {
+                return true;
+            }
+            m_frame = frame::outside;
+            break;
+        case frame::element:
+            return true;
+        case frame::separator:
+            if (c != ',' && c != ']') {
+                m_error = "',' or ']' expected";
+                return false;
+            }
+            m_frame = c == ',' ? frame::element : frame::outside;
+            break;
+    }
+    m_scan++;
+    m_consumed = m_scan;
+    return true;
+}
+
+inline value stream_splitter::next() noexcept {
+    if (failed()) {
+        return value();
+    }
+
+    while (m_scan < m_size) {
+        char c = m_buffer[m_scan];
+        if (!m_in_value) {
+            if (is_whitespace(c)) {
+                m_scan++;
+                m_consumed = m_scan;
+                continue;
+            }
+            std::size_t scan = m_scan;
+            if (!step_outside(c)) {
+                return value();
+            }
+            if (m_scan != scan) {// a bracket or separator around the elements
+                continue;
+            }
+            m_in_value = true;
+            m_start = m_scan;
+            m_depth = 0;
+            m_scalar = c != '{' && c != '[' && c != '\"';
+            if (m_scalar) {
+                m_scan++;
+                continue;
+            }
+        }
+        else if (m_scalar) {
+            if (ends_scalar(c)) {
+                return complete(m_scan);
+            }
+            m_scan++;
+            continue;
+        }
+        else if (m_in_string) {
+            m_scan++;
+            if (m_escape) {
+                m_escape = false;
+            }
+            else if (c == '\\') {
+                m_escape = true;
+            }
+            else if (c == '\"') {
+                m_in_string = false;
+                if (!m_depth) {
+                    return complete(m_scan);
+                }
+            }
+            continue;
+        }
+
+        m_scan++;
+        if (c == '\"') {
+            m_in_string = true;
+        }
+        else if (c == '{' || c == '[') {
+            m_depth++;
+        }
+        else if ((c == '}' || c == ']') && !--m_depth) {
+            return complete(m_scan);
+        }
+    }
+
+    if (m_finished) {
+        if (m_in_value && m_scalar) {
+            return complete(m_scan);
+        }
+        if (m_in_value || m_frame != frame::outside) {
+            return fail("unexpected end of stream");
+        }
+    }
+    else if (m_size == m_capacity && !m_consumed) {
+        return fail("value does not fit in the buffer");
+    }
+    return value();
+}
+
+// Parses many small documents on any number of threads, without allocating. Every thread that calls work() claims
+// blocks of documents from a shared counter until none are left, so threads that finish early take more of the batch.
+class batch {
+public:
+    batch(const std::string_view* jsons, value* out, std::size_t count, std::size_t block = 64) noexcept
+        : m_jsons(jsons), m_out(out), m_count(jsons && out ? count : 0), m_block(block ? block : 1) {}
+    batch(const batch&) = delete;
+    batch& operator=(const batch&) = delete;
+
+    std::size_t work() noexcept;// returns the number of valid documents parsed by the calling thread
+    std::size_t valid() const noexcept { return m_valid.load(); }// total, once every call to work() returned
+
+private:
+    const std::string_view* m_jsons;
+    value* m_out;
+    std::size_t m_count;
+    std::size_t m_block;
+    std::atomic<std::size_t> m_next{0};
+    std::atomic<std::size_t> m_valid{0};
+};
+
+inline std::size_t batch::work() noexcept {
+    unsigned char stack[(OIJSON_MAX_DEPTH + 7) / 8];
+    std::size_t valid = 0;
+    for (std::size_t first = m_next.fetch_add(m_block, std::memory_order_relaxed); first < m_count;
+        first = m_next.fetch_add(m_block, std::memory_order_relaxed)) {
+        std::size_t last = m_count - first < m_block ? m_count : first + m_block;
+        for (std::size_t i = first; i < last; i++) {
+            m_out[i] = value(c::oijson_parse_with_stack(m_jsons[i].data(), static_cast<unsigned int>(m_jsons[i].size()), stack, sizeof(stack)));
+            valid += m_out[i].valid();
+        }
+    }
+    m_valid.fetch_add(valid, std::memory_order_relaxed);
+    return valid;
+}
+
+// Validates one large document on any number of threads, with the same result as oijson_parse. The document is cut
+// into chunks held by the caller, see oijson_chunk_split, and more chunks than threads balance the load. Each thread
+// calls work, which skims chunks until none is left, waits for the thread skimming the last one to stitch the chunks
+// together, and then validates chunks until none is left. No threads are created, start them with std::thread or hand
+// work to an existing pool, and read result once every work call returned.
+class parallel_parser {
+public:
+    parallel_parser(std::string_view json, c::oijson_chunk* chunks, std::size_t count) noexcept
+        : m_chunks(chunks),
+          m_count(c::oijson_chunk_split(json.data(), static_cast<unsigned int>(json.size()), chunks, static_cast<unsigned int>(count))),
+          m_stitched(m_count == 0) {}
+    parallel_parser(const parallel_parser&) = delete;
+    parallel_parser& operator=(const parallel_parser&) = delete;
+
+    void work() noexcept;
+    value result() const noexcept { return m_count ? value(c::oijson_chunk_result(m_chunks, m_count)) : value(); }
+
+private:
+    c::oijson_chunk* m_chunks;
+    unsigned int m_count;
+    std::atomic<bool> m_stitched;
+    std::atomic<unsigned int> m_next_scan{0};
+    std::atomic<unsigned int> m_scanned{0};
+    std::atomic<unsigned int> m_next_validate{0};
+    unsigned int m_validate_count = 0;// written before m_stitched is set
+};
+
+inline void parallel_parser::work() noexcept {
+    for (unsigned int i = m_next_scan.fetch_add(1, std::memory_order_relaxed); i < m_count; i = m_next_scan.fetch_add(1, std::memory_order_relaxed)) {
+        c::oijson_chunk_scan(&m_chunks[i]);
+        if (m_scanned.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {// every summary is written
+            m_validate_count = c::oijson_chunk_stitch(m_chunks, m_count);
+            m_stitched.store(true, std::memory_order_release);
+        }
+    }
+    while (!m_stitched.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    for (unsigned int i = m_next_validate.fetch_add(1, std::memory_order_relaxed); i < m_validate_count; i = m_next_validate.fetch_add(1, std::memory_order_relaxed)) {
+        c::oijson_chunk_validate(&m_chunks[i]);
+    }
+}
+
+#ifdef OIJSON_COROUTINES
+
+// Hands values to a coroutine as bytes arrive. The coroutine awaits next(), which suspends until a value is complete,
+// while a reader, such as an event loop callback, passes bytes to feed() or reads into space() and calls commit().
+// Both resume the waiting coroutine, which runs until it awaits again before they return. An invalid value means the
+// stream ended, see done(), or failed, see error().
+class async_parser {
+public:
+    async_parser(char* buffer, std::size_t capacity, split mode = split::values) noexcept : m_splitter(buffer, capacity, mode) {}
+    async_parser(const async_parser&) = delete;
+    async_parser& operator=(const async_parser&) = delete;
+
+    class awaiter {
+    public:
+        explicit awaiter(async_parser& parser) noexcept : m_parser(parser) {}
+        bool await_ready() noexcept { return m_parser.poll(); }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { m_parser.m_waiting = handle; }
+        value await_resume() noexcept { return m_parser.m_result; }
+
+    private:
+        async_parser& m_parser;
+    };
+
+    awaiter next() noexcept { return awaiter(*this); }
+
+    char* space() noexcept { return m_splitter.space(); }
+    std::size_t space_size() const noexcept { return m_splitter.space_size(); }
+    void commit(std::size_t size) noexcept {
+        m_splitter.commit(size);
+        resume();
+    }
+    std::size_t feed(std::string_view data) noexcept {
+        std::size_t size = m_splitter.feed(data);
+        resume();
+        return size;
+    }
+    void finish() noexcept {
+        m_splitter.finish();
+        resume();
+    }
+
+    bool waiting() const noexcept { return static_cast<bool>(m_waiting); }
+    bool done() const noexcept { return m_splitter.done(); }
+    const char* error() const noexcept { return m_splitter.error(); }
+
+private:
+    bool poll() noexcept {// true when the awaiting coroutine can continue
+        m_result = m_splitter.next();
+        return m_result.valid() || m_splitter.failed() || m_splitter.done();
+    }
+    void resume() noexcept {
+        if (m_waiting && poll()) {
+            std::coroutine_handle<> handle = m_waiting;
+            m_waiting = nullptr;
+            handle.resume();
+        }
+    }
+
+    stream_splitter m_splitter;
+    std::coroutine_handle<> m_waiting;
+    value m_result;
+};
+
+#endif
+
+}
+
+#endif//OIJSON_HPP